@@ -0,0 +1,319 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Architecture-dependent functions, ARMv6-M (Cortex-M0/M0+) port.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ * @note All functions beginning with "sk_arch_*" will be defined here but
+ * their implementation may be somewhere else in src/sk/arch/<arch>/<arch>.c
+ *
+ * Tasks run in thread mode on the process stack (PSP), exceptions and the
+ * kernel on the main stack (MSP). SysTick is the preemption timer and elects
+ * the next task, the switch itself is done by PendSV which runs at the lowest
+ * priority once every other handler is done. SVC starts the first task and is
+ * the entry point for syscalls made with interrupts enabled.
+ */
+
+#ifndef SKIRT_ARCH_H
+#define SKIRT_ARCH_H
+
+#include <sk/skirt.h>
+#include <sk/types.h>
+#include <sk/task.h>
+
+/**
+ * @brief Constants already live in flash, strings are used as they are.
+ */
+#define SK_PSTR(s) (s)
+#define SK_PROGMEM
+#define sk_arch_pgm_read_byte(p) (*(const unsigned char *)(p))
+#define sk_arch_pgm_read_ptr(p) (*(const void *const *)(p))
+
+/**
+ * @brief This platform supports a serial output.
+ */
+#define SK_SERIAL_SUPPORT 1
+
+#ifdef SKIRT_KERNEL
+
+/* r4-r11 saved by PendSV, then the exception frame stacked by the CPU. */
+#define SK_CONTEXT_SZ 64
+
+#ifndef F_CPU
+#define F_CPU 16000000
+#endif /* F_CPU */
+
+#ifdef SKIRT_TWI
+#error "SKIRT_TWI is not supported on the armv6m architecture yet!"
+#endif
+
+#ifdef SKIRT_SPI
+#error "SKIRT_SPI is not supported on the armv6m architecture yet!"
+#endif
+
+#ifdef SKIRT_ADC
+#error "SKIRT_ADC is not supported on the armv6m architecture yet!"
+#endif
+
+/* One preemption timer count lasts 2^SKIRT_ARMV6M_COUNT_SHIFT CPU cycles,
+ * 8 makes SKIRT_PREEMPT_TIME mean the same as the AVR prescaler set to 256. */
+#ifndef SKIRT_ARMV6M_COUNT_SHIFT
+#define SKIRT_ARMV6M_COUNT_SHIFT 8
+#endif /* SKIRT_ARMV6M_COUNT_SHIFT */
+
+#if ((SKIRT_PREEMPT_TIME + 1UL) << SKIRT_ARMV6M_COUNT_SHIFT) > 0x1000000UL
+#error "SKIRT_PREEMPT_TIME does not fit in the 24-bit SysTick counter!"
+#endif
+
+/* System control space registers. */
+#define SK_SYST_CSR (*(volatile unsigned long *)0xE000E010UL)
+#define SK_SYST_RVR (*(volatile unsigned long *)0xE000E014UL)
+#define SK_SYST_CVR (*(volatile unsigned long *)0xE000E018UL)
+#define SK_SCB_ICSR (*(volatile unsigned long *)0xE000ED04UL)
+#define SK_SCB_SHPR2 (*(volatile unsigned long *)0xE000ED1CUL)
+#define SK_SCB_SHPR3 (*(volatile unsigned long *)0xE000ED20UL)
+#define SK_NVIC_ISER (*(volatile unsigned long *)0xE000E100UL)
+
+#define SK_ICSR_PENDSVSET (1UL << 28)
+#define SK_ICSR_PENDSTSET (1UL << 26)
+
+/**
+ * @brief SVC numbers understood by the kernel.
+ */
+enum sk_svc {
+	/* Start the first task, used once by sk_arch_first_yield(). */
+	SK_SVC_START = 0,
+	/* Give the CPU away, for code running with interrupts enabled. */
+	SK_SVC_YIELD = 1,
+	/* Resume the context interrupted by signal handlers. */
+	SK_SVC_SIGRETURN = 2,
+};
+
+/**
+ * @brief Enter the kernel through SVC.
+ * @param num SVC number (enum sk_svc).
+ * @note Interrupts must be enabled, SVC escalates to HardFault otherwise.
+ */
+#define sk_arch_syscall(num) \
+	__asm__ __volatile__("svc %0" ::"i"(num) : "memory")
+
+/**
+ * @brief Yield task to another, defined in armv6m.c.
+ * @note Interrupts must be disabled, they are enabled on return.
+ */
+extern void sk_arch_yield(void);
+
+#ifdef SKIRT_SIG
+/**
+ * @brief Go through PendSV if the elected task has signals to handle, it
+ * stacks the handler frame (see armv6m.c).
+ */
+#define sk_arch_sig_prepare(task)                                      \
+	do {                                                           \
+		if (!(task)->sig_frame &&                              \
+		    ((task)->sig_pending & ~(task)->sig_blocked)) {    \
+			SK_SCB_ICSR = SK_ICSR_PENDSVSET;               \
+		}                                                      \
+	} while (0)
+#endif /* SKIRT_SIG */
+
+/**
+ * @brief Nothing to remember, exceptions always run on the main stack.
+ */
+#define sk_arch_kernel_stack_init() \
+	do {                        \
+	} while (0)
+
+/**
+ * @brief Configure SysTick and exception priorities.
+ * @note The counter starts with the first task.
+ */
+extern void sk_arch_init_preempt(void);
+
+/**
+ * @brief Switch to the first task through SVC, main() is never returned to.
+ */
+extern SK_NORETURN void sk_arch_first_yield(sk_task *task);
+
+/**
+ * @brief Preemption timer counts from 0 to SKIRT_PREEMPT_TIME.
+ */
+#define SK_ARCH_TIMER_PERIOD ((unsigned long)SKIRT_PREEMPT_TIME + 1)
+
+/**
+ * @brief Current preemption timer count, SysTick counts down.
+ */
+#define sk_arch_timer_now() \
+	((sk_size_t)((SK_SYST_RVR - SK_SYST_CVR) >> SKIRT_ARMV6M_COUNT_SHIFT))
+
+/**
+ * @brief Preemption timer reached its top value and the tick is not serviced yet.
+ */
+#define sk_arch_timer_wrapped() (SK_SCB_ICSR & SK_ICSR_PENDSTSET)
+
+/**
+ * @brief Convert preemption timer counts to microseconds.
+ */
+#define sk_arch_timer_to_us(counts)                                \
+	(((unsigned long long)(counts) << SKIRT_ARMV6M_COUNT_SHIFT) / \
+	 (F_CPU / 1000000UL))
+
+/**
+ * @brief Halfword address of the code interrupted by the context saved at sp.
+ * @note Stacked PC is the 7th word of the exception frame, halfwords keep
+ * the profiler bins the same size as AVR words.
+ */
+#define sk_arch_context_pc(sp) \
+	(((const unsigned long *)(sp))[8 + 6] >> 1)
+
+/**
+ * @brief Nothing to save, the interrupted context is on the task stack.
+ */
+#define sk_arch_irq_enter() \
+	do {                \
+	} while (0)
+
+/**
+ * @brief Reschedule if needed when leaving a SKIRT_IRQ() handler.
+ * @note The switch happens through PendSV once the handler returns.
+ */
+extern void sk_arch_irq_exit(void);
+
+/**
+ * @brief Wrap an interrupt handler so it can wake tasks.
+ * @param vector Handler name in the vector table (ex: IRQ6_Handler).
+ * @param irq sk_irq object dispatched by this vector.
+ * @note Handlers do not nest, like on AVR.
+ */
+#define sk_arch_irq_define(vector, irq)  \
+	void vector(void)                \
+	{                                \
+		sk_arch_disable_int();   \
+		sk_arch_irq_enter();     \
+		sk_irq_dispatch(&irq);   \
+		sk_arch_irq_exit();      \
+		sk_arch_enable_int();    \
+	}
+
+/**
+ * @brief Build the initial context of a task.
+ * @param func Task function pointer for initialization.
+ * @param task Newly created task.
+ * @note Returning from func ends the task.
+ */
+extern void sk_arch_stack_init(sk_task_func func, sk_task *task);
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Nop on ARM architecture.
+ */
+#define sk_arch_nop() __asm__ __volatile__("nop")
+
+/**
+ * @brief Sleep until the next interrupt, called by the idle task.
+ */
+#define sk_arch_idle() __asm__ __volatile__("wfi")
+
+/**
+ * @brief Enable interrupts.
+ */
+#define sk_arch_enable_int() __asm__ __volatile__("cpsie i" ::: "memory")
+
+/**
+ * @brief Disable interrupts.
+ */
+#define sk_arch_disable_int() __asm__ __volatile__("cpsid i" ::: "memory")
+
+/**
+ * @brief Disable interrupts and return previous state, usable from an ISR.
+ * @return Interrupt state to be given back to sk_arch_restore_int().
+ */
+SK_INLINE sk_int_state_t sk_arch_save_int(void)
+{
+	sk_int_state_t state;
+	__asm__ __volatile__("mrs %0, primask\n\t"
+			     "cpsid i"
+			     : "=r"(state)
+			     :
+			     : "memory");
+	return state;
+}
+
+/**
+ * @brief Restore interrupt state saved by sk_arch_save_int().
+ * @param state Previous interrupt state.
+ */
+SK_INLINE void sk_arch_restore_int(sk_int_state_t state)
+{
+	__asm__ __volatile__("msr primask, %0" ::"r"(state) : "memory");
+}
+
+/**
+ * @brief Check if interrupts were enabled in a state saved by
+ * sk_arch_save_int(), only true in a task outside of a critical section
+ * (ISRs run with interrupts disabled).
+ */
+#define sk_arch_int_enabled(state) (((state) & 1) == 0)
+
+#ifdef SK_SERIAL_SUPPORT
+
+/**
+ * @brief Put a character on the serial port.
+ * @param c Character.
+ */
+extern void sk_arch_serial_putc(char c);
+
+/**
+ * @brief Initialize the board serial port, defined in <board>.c.
+ */
+extern void sk_arch_serial_init(void);
+
+#ifdef SKIRT_LINK
+/**
+ * @brief Enable the board UART interrupts for sk/link.h, defined in <board>.c.
+ */
+extern void sk_arch_link_init(void);
+
+/**
+ * @brief Send the first byte of a frame if the UART is idle.
+ * @note Called with interrupts disabled, the UART interrupt sends the rest.
+ */
+extern void sk_arch_link_tx_start(void);
+#endif /* SKIRT_LINK */
+
+#endif /* SK_SERIAL_SUPPORT */
+
+#endif /* SKIRT_ARCH_H */
@@ -50,6 +50,28 @@ knowledge of the CeCILL license and that you accept its terms.
 /* Using provided AVR headers. */
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+/**
+ * @brief Keep a string literal in flash instead of SRAM.
+ * @note Read it back with sk_arch_pgm_read_byte() or sk_serial_print_P().
+ */
+#define SK_PSTR(s) PSTR(s)
+
+/**
+ * @brief Place a constant object in flash.
+ */
+#define SK_PROGMEM PROGMEM
+
+/**
+ * @brief Read a byte from flash.
+ */
+#define sk_arch_pgm_read_byte(p) pgm_read_byte(p)
+
+/**
+ * @brief Read a pointer from flash.
+ */
+#define sk_arch_pgm_read_ptr(p) pgm_read_ptr(p)
 
 /**
  * @brief This platform supports a serial output.
@@ -58,8 +80,32 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #ifdef SKIRT_KERNEL
 
-#ifdef __AVR_ATmega328P__
+#if defined(__AVR_ATmega328P__)
+/* 33 registers and a 2-byte return address. */
 #define SK_CONTEXT_SZ 35
+#define SK_ARCH_PUSH_EXT ""
+#define SK_ARCH_POP_EXT ""
+#elif defined(__AVR_ATmega2560__)
+/* 33 registers, RAMPZ, EIND and a 3-byte return address. */
+#define SK_CONTEXT_SZ 38
+/* RAMPZ (I/O 0x3B) and EIND (I/O 0x3C) are saved right after SREG. */
+#define SK_ARCH_PUSH_EXT                                              \
+	"in     __tmp_reg__, 0x3b                       \n\t"         \
+	"push   __tmp_reg__                             \n\t"         \
+	"in     __tmp_reg__, 0x3c                       \n\t"         \
+	"push   __tmp_reg__                             \n\t"
+#define SK_ARCH_POP_EXT                                               \
+	"pop    __tmp_reg__                             \n\t"         \
+	"out    0x3c, __tmp_reg__                       \n\t"         \
+	"pop    __tmp_reg__                             \n\t"         \
+	"out    0x3b, __tmp_reg__                       \n\t"
+#else
+#error "MCU not supported"
+#endif
+
+#ifndef F_CPU
+#define F_CPU 16000000
+#endif /* F_CPU */
 
 /**
  * Used under MIT License.
@@ -71,6 +117,7 @@ knowledge of the CeCILL license and that you accept its terms.
 		"in     __tmp_reg__, __SREG__                   \n\t" \
 		"cli                                            \n\t" \
 		"push   __tmp_reg__                             \n\t" \
+		SK_ARCH_PUSH_EXT                                      \
 		"push   __zero_reg__                            \n\t" \
 		"clr    __zero_reg__                            \n\t" \
 		"push   r2                                      \n\t" \
@@ -141,14 +188,11 @@ knowledge of the CeCILL license and that you accept its terms.
 		"pop  r3                     \n\t"                    \
 		"pop  r2                     \n\t"                    \
 		"pop    __zero_reg__                            \n\t" \
+		SK_ARCH_POP_EXT                                       \
 		"pop    __tmp_reg__                             \n\t" \
 		"out    __SREG__, __tmp_reg__                   \n\t" \
 		"pop    __tmp_reg__                             \n\t")
 
-#else
-#error "MCU not supported"
-#endif
-
 /**
  * @brief Yield task to another, defined in avr.c.
  */
@@ -174,6 +218,89 @@ extern void sk_arch_yield(void) SK_NAKED;
 		sk_arch_restore_context(); \
 	} while (0)
 
+extern sk_stack_t *volatile irq_sp;
+extern sk_stack_t *volatile kernel_sp;
+
+/**
+ * @brief Remember the top of the current stack to be used as kernel stack.
+ * @note Called once by sk_kernel_start(), main() stack is never returned to.
+ */
+#define sk_arch_kernel_stack_init() (kernel_sp = (sk_stack_t *)SP)
+
+/**
+ * @brief Move SP to the kernel stack, task stacks only hold their saved context.
+ */
+#define sk_arch_use_kernel_stack()                      \
+	do {                                            \
+		if (kernel_sp) {                        \
+			SP = (sk_size_t)kernel_sp;      \
+		}                                       \
+	} while (0)
+
+/**
+ * @brief Save SP (stored in irq_sp) of the interrupted task when entering a SKIRT_IRQ() handler.
+ */
+extern void sk_arch_irq_enter(void);
+
+/**
+ * @brief Reschedule if needed when leaving a SKIRT_IRQ() handler.
+ * @return Stack pointer of the task to resume.
+ */
+extern sk_stack_t *sk_arch_irq_exit(void);
+
+/**
+ * @brief Wrap an interrupt vector so its handler can wake tasks.
+ * @param vector AVR interrupt vector (ex: INT0_vect).
+ * @param irq sk_irq object dispatched by this vector.
+ */
+#define sk_arch_irq_define(vector, irq)                          \
+	ISR(vector, ISR_NAKED)                                   \
+	{                                                        \
+		sk_arch_save_context();                          \
+		irq_sp = (sk_stack_t *)SP;                       \
+		sk_arch_use_kernel_stack();                      \
+		sk_arch_irq_enter();                             \
+		sk_irq_dispatch(&irq);                           \
+		SP = (sk_size_t)sk_arch_irq_exit();              \
+		sk_arch_restore_context();                       \
+		__asm__ __volatile__("reti" ::: "memory");       \
+	}
+
+/**
+ * @brief Preemption timer (TIMER1) counts from 0 to SKIRT_PREEMPT_TIME.
+ */
+#define SK_ARCH_TIMER_PERIOD ((unsigned long)SKIRT_PREEMPT_TIME + 1)
+
+/**
+ * @brief Current preemption timer count.
+ */
+#define sk_arch_timer_now() ((sk_size_t)TCNT1)
+
+/**
+ * @brief Preemption timer reached its top value and the tick is not serviced yet.
+ */
+#define sk_arch_timer_wrapped() (TIFR1 & (1 << OCF1A))
+
+/**
+ * @brief Convert preemption timer counts (prescaler set to 256) to microseconds.
+ */
+#define sk_arch_timer_to_us(counts) \
+	((counts) * 256ULL / (F_CPU / 1000000UL))
+
+/**
+ * @brief Word address of the code interrupted by the context saved at sp.
+ * @note The return address is pushed big-endian right above the registers.
+ */
+#ifdef __AVR_3_BYTE_PC__
+#define sk_arch_context_pc(sp)                                   \
+	((((unsigned long)(sp)[SK_CONTEXT_SZ - 2]) << 16) |      \
+	 (((unsigned long)(sp)[SK_CONTEXT_SZ - 1]) << 8) |       \
+	 (sp)[SK_CONTEXT_SZ])
+#else
+#define sk_arch_context_pc(sp) \
+	((((unsigned long)(sp)[SK_CONTEXT_SZ - 1]) << 8) | (sp)[SK_CONTEXT_SZ])
+#endif /* __AVR_3_BYTE_PC__ */
+
 /**
  * @brief Enable preemption timer.
  */
@@ -193,6 +320,11 @@ extern void sk_arch_init_preempt(void);
  */
 #define sk_arch_nop() __asm__ __volatile__("nop");
 
+/**
+ * @brief Called in a loop by the idle task.
+ */
+#define sk_arch_idle() sk_arch_nop()
+
 /**
  * @brief Disable interrupts.
  */
@@ -203,6 +335,33 @@ extern void sk_arch_init_preempt(void);
  */
 #define sk_arch_disable_int() cli()
 
+/**
+ * @brief Disable interrupts and return previous state, usable from an ISR.
+ * @return Interrupt state to be given back to sk_arch_restore_int().
+ */
+SK_INLINE sk_int_state_t sk_arch_save_int(void)
+{
+	sk_int_state_t state = SREG;
+	cli();
+	return state;
+}
+
+/**
+ * @brief Restore interrupt state saved by sk_arch_save_int().
+ * @param state Previous interrupt state.
+ */
+SK_INLINE void sk_arch_restore_int(sk_int_state_t state)
+{
+	SREG = state;
+}
+
+/**
+ * @brief Check if interrupts were enabled in a state saved by
+ * sk_arch_save_int(), only true in a task outside of a critical section
+ * (ISRs run with interrupts disabled).
+ */
+#define sk_arch_int_enabled(state) (((state) & (1 << SREG_I)) != 0)
+
 #ifdef SK_SERIAL_SUPPORT
 
 /**
@@ -216,8 +375,54 @@ extern void sk_arch_serial_putc(char c);
  */
 extern void sk_arch_serial_init(void);
 
+#ifdef SKIRT_LINK
+/**
+ * @brief Enable the USART0 receive interrupt for sk/link.h.
+ */
+extern void sk_arch_link_init(void);
+
+/**
+ * @brief Enable the USART0 data register empty interrupt, it sends queued frames.
+ * @note Called with interrupts disabled.
+ */
+#define sk_arch_link_tx_start() (UCSR0B |= (1 << UDRIE0))
+#endif /* SKIRT_LINK */
+
 #endif /* SK_SERIAL_SUPPORT */
 
+/**
+ * @brief Build a context returning to func at sp.
+ * @param sp First free byte of the stack.
+ * @param func Function the context returns to.
+ * @return Stack pointer of the new context.
+ */
+SK_INLINE sk_stack_t *sk_arch_context_push(sk_stack_t *sp, sk_task_func func)
+{
+	*sp = (uint8_t)((uint16_t)func & 0xff);
+	sp--;
+	*sp = (uint8_t)(((uint16_t)func >> 8) & 0xff);
+	sp--;
+#ifdef __AVR_3_BYTE_PC__
+	/* Function pointers are 16-bit, code above 128KiB is reached through
+	 * linker stubs so the top byte is always 0. */
+	*sp = (uint8_t)0x00;
+	sp--;
+#endif /* __AVR_3_BYTE_PC__ */
+	*sp = (uint8_t)0x00; /* r0 to 0 */
+	sp--;
+	*sp = (uint8_t)0x80; /* Interrupts ON */
+	sp--;
+#ifdef __AVR_ATmega2560__
+	*sp = (uint8_t)0x00; /* RAMPZ to 0 */
+	sp--;
+	*sp = (uint8_t)0x00; /* EIND to 0 */
+	sp--;
+#endif /* __AVR_ATmega2560__ */
+	*sp = (uint8_t)0x00; /* r1 to 0 */
+	/* r2 to r31 are left as they are. */
+	return sp - 31;
+}
+
 /**
  * @brief Initialize stack for a task.
  * @param func Task function pointer for initialization.
@@ -227,18 +432,30 @@ SK_INLINE void sk_arch_stack_init(sk_task_func func, sk_task *task)
 {
 	SK_ASSERT(task->stack_sz > SK_CONTEXT_SZ);
 
-	task->sp = (task->stack + task->stack_sz - 1);
-	*(task->sp) = (uint8_t)((uint16_t)func & 0xff);
-	task->sp--;
-	*(task->sp) = (uint8_t)(((uint16_t)func >> 8) & 0xff);
-	task->sp--;
-	*task->sp = (uint8_t)0x00; /* r0 to 0 */
-	task->sp--;
-	*task->sp = (uint8_t)0x80; /* Interrupts ON */
-	task->sp--;
-	*task->sp = (uint8_t)0x00; /* r1 to 0 */
-	task->sp -= (SK_CONTEXT_SZ - 4);
+	task->sp = sk_arch_context_push(task->stack + task->stack_sz - 1, func);
 }
+
+#ifdef SKIRT_SIG
+/**
+ * @brief Run signal handlers, then restore the context right above, defined
+ * in avr.c.
+ */
+extern void sk_arch_sig_trampoline(void) SK_NAKED;
+
+/**
+ * @brief Make an elected task enter sk_arch_sig_trampoline() if it has
+ * signals to handle, its saved context is kept right above the new one.
+ */
+#define sk_arch_sig_prepare(task)                                        \
+	do {                                                             \
+		if (sk_sig_need_frame(task)) {                           \
+			SK_ASSERT((task)->sp - SK_CONTEXT_SZ >=          \
+				  (task)->stack);                        \
+			(task)->sp = sk_arch_context_push(               \
+				(task)->sp, sk_arch_sig_trampoline);     \
+		}                                                        \
+	} while (0)
+#endif /* SKIRT_SIG */
 #endif /* SKIRT_KERNEL */
 
 #endif /* SKIRT_ARCH_H */
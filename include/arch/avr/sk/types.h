@@ -47,9 +47,22 @@ knowledge of the CeCILL license and that you accept its terms.
 
 typedef unsigned char sk_stack_t;
 typedef size_t sk_size_t;
+/* Saved interrupt state (SREG on AVR). */
+typedef unsigned char sk_int_state_t;
 
 #ifndef NULL
 #define NULL ((void *)0)
 #endif /* NULL */
 
+#ifdef __AVR_ATmega2560__
+/* 8KiB of SRAM leaves room for larger task sets and the 3-byte return addresses. */
+#ifndef SKIRT_TASK_MAX
+#define SKIRT_TASK_MAX 32
+#endif /* SKIRT_TASK_MAX */
+
+#ifndef SKIRT_TASK_STACK_SZ
+#define SKIRT_TASK_STACK_SZ 96
+#endif /* SKIRT_TASK_STACK_SZ */
+#endif /* __AVR_ATmega2560__ */
+
 #endif /* SKIRT_SK_TYPES_H */
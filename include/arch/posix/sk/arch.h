@@ -0,0 +1,280 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Architecture-dependent functions, host (POSIX) port.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ * @note All functions beginning with "sk_arch_*" will be defined here but
+ * their implementation may be somewhere else in src/sk/arch/<arch>/<arch>.c
+ *
+ * Tasks run as ucontexts on host stacks, the preemption timer is SIGALRM and
+ * disabling interrupts blocks SIGALRM and the signals used as IRQs. Time is
+ * virtual: a tick lasts SK_ARCH_TIMER_PERIOD counts of SKIRT_POSIX_COUNT_NS
+ * simulated nanoseconds, whatever SKIRT_POSIX_TICK_US host time it takes.
+ */
+
+#ifndef SKIRT_ARCH_H
+#define SKIRT_ARCH_H
+
+#include <sk/skirt.h>
+#include <sk/types.h>
+#include <sk/task.h>
+
+#include <errno.h>
+
+/**
+ * @brief Constants already live in the same address space, strings are used as they are.
+ */
+#define SK_PSTR(s) (s)
+#define SK_PROGMEM
+#define sk_arch_pgm_read_byte(p) (*(const unsigned char *)(p))
+#define sk_arch_pgm_read_ptr(p) (*(const void *const *)(p))
+
+/**
+ * @brief This platform supports a serial output (stdout).
+ */
+#define SK_SERIAL_SUPPORT 1
+
+#ifdef SKIRT_KERNEL
+
+/* Contexts are kept outside of task stacks. */
+#define SK_CONTEXT_SZ 0
+
+/* Host stack of each task, task stacks given to the kernel are not used. */
+#ifndef SKIRT_POSIX_STACK_SZ
+#define SKIRT_POSIX_STACK_SZ 65536
+#endif /* SKIRT_POSIX_STACK_SZ */
+
+/* Simulated duration of one timer count (same as the ATmega328P at 16MHz). */
+#ifndef SKIRT_POSIX_COUNT_NS
+#define SKIRT_POSIX_COUNT_NS 16000
+#endif /* SKIRT_POSIX_COUNT_NS */
+
+/* Host time between two ticks, lower it to run faster than real time. */
+#ifndef SKIRT_POSIX_TICK_US
+#define SKIRT_POSIX_TICK_US \
+	(SK_ARCH_TIMER_PERIOD * SKIRT_POSIX_COUNT_NS / 1000)
+#endif /* SKIRT_POSIX_TICK_US */
+
+#ifdef SKIRT_PROFILE
+#error "SKIRT_PROFILE is not supported on the posix architecture!"
+#endif
+
+#ifdef SKIRT_TWI
+#error "SKIRT_TWI is not supported on the posix architecture!"
+#endif
+
+#ifdef SKIRT_SPI
+#error "SKIRT_SPI is not supported on the posix architecture!"
+#endif
+
+#ifdef SKIRT_ADC
+#error "SKIRT_ADC is not supported on the posix architecture!"
+#endif
+
+/**
+ * @brief Yield task to another, defined in posix.c.
+ * @note Interrupts must be disabled, they are enabled on return.
+ */
+extern void sk_arch_yield(void);
+
+/**
+ * @brief Nothing to remember, tasks never run on main() stack.
+ */
+#define sk_arch_kernel_stack_init() \
+	do {                        \
+	} while (0)
+
+/**
+ * @brief Start a SIGALRM timer used as preemption mechanism.
+ */
+extern void sk_arch_init_preempt(void);
+
+/**
+ * @brief Switch to the first task, main() context is never returned to.
+ */
+extern SK_NORETURN void sk_arch_first_yield(sk_task *task);
+
+/**
+ * @brief Preemption timer counts from 0 to SKIRT_PREEMPT_TIME.
+ */
+#define SK_ARCH_TIMER_PERIOD ((unsigned long)SKIRT_PREEMPT_TIME + 1)
+
+/**
+ * @brief Current (virtual) preemption timer count.
+ */
+extern sk_size_t sk_arch_timer_now(void);
+
+/**
+ * @brief Preemption timer expired and the tick is not serviced yet.
+ */
+extern bool sk_arch_timer_wrapped(void);
+
+/**
+ * @brief Convert preemption timer counts to simulated microseconds.
+ */
+#define sk_arch_timer_to_us(counts) \
+	((counts) * (unsigned long long)SKIRT_POSIX_COUNT_NS / 1000ULL)
+
+/**
+ * @brief Route a signal to a SKIRT_IRQ() handler, called before main().
+ * @param sig Signal number.
+ * @param handler Signal handler.
+ */
+extern void sk_arch_irq_install(int sig, void (*handler)(int));
+
+/**
+ * @brief Nothing to save, the interrupted task context is kept by the signal frame.
+ */
+#define sk_arch_irq_enter() \
+	do {                \
+	} while (0)
+
+/**
+ * @brief Reschedule if needed when leaving a SKIRT_IRQ() handler.
+ */
+extern void sk_arch_irq_exit(void);
+
+/**
+ * @brief Wrap a signal so its handler can wake tasks.
+ * @param vector Signal number (ex: SIGUSR1).
+ * @param irq sk_irq object dispatched by this signal.
+ */
+#define sk_arch_irq_define(vector, irq)                                 \
+	static void sk_arch_irq_##irq(int sig)                          \
+	{                                                               \
+		int saved_errno = errno;                                \
+		(void)sig;                                              \
+		sk_arch_irq_enter();                                    \
+		sk_irq_dispatch(&irq);                                  \
+		sk_arch_irq_exit();                                     \
+		errno = saved_errno;                                    \
+	}                                                               \
+	__attribute__((constructor)) static void sk_arch_irq_init_##irq( \
+		void)                                                   \
+	{                                                               \
+		sk_arch_irq_install(vector, sk_arch_irq_##irq);         \
+	}
+
+/**
+ * @brief Initialize the host context of a task.
+ * @param func Task function pointer for initialization.
+ * @param task Newly created task.
+ */
+extern void sk_arch_stack_init(sk_task_func func, sk_task *task);
+
+/**
+ * @brief Nothing to prepare, pending signals are handled by the elected task
+ * itself when its context is resumed (see posix.c).
+ */
+#define sk_arch_sig_prepare(task) \
+	do {                      \
+		(void)(task);     \
+	} while (0)
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Nothing to do on a host.
+ */
+#define sk_arch_nop() \
+	do {          \
+	} while (0)
+
+/**
+ * @brief Wait for the next interrupt, called by the idle task.
+ * @note With SKIRT_POSIX_SKIP_IDLE, the next tick happens right away
+ * instead (idle time is skipped on the virtual clock).
+ */
+extern void sk_arch_idle(void);
+
+/**
+ * @brief Enable interrupts.
+ */
+extern void sk_arch_enable_int(void);
+
+/**
+ * @brief Disable interrupts.
+ */
+extern void sk_arch_disable_int(void);
+
+/**
+ * @brief Disable interrupts and return previous state, usable from an ISR.
+ * @return Interrupt state to be given back to sk_arch_restore_int().
+ */
+extern sk_int_state_t sk_arch_save_int(void);
+
+/**
+ * @brief Restore interrupt state saved by sk_arch_save_int().
+ * @param state Previous interrupt state.
+ */
+extern void sk_arch_restore_int(sk_int_state_t state);
+
+/**
+ * @brief Check if interrupts were enabled in a state saved by
+ * sk_arch_save_int(), only true in a task outside of a critical section
+ * (ISRs run with interrupts disabled).
+ */
+#define sk_arch_int_enabled(state) (state)
+
+#ifdef SK_SERIAL_SUPPORT
+
+/**
+ * @brief Put a character on stdout.
+ * @param c Character.
+ */
+extern void sk_arch_serial_putc(char c);
+
+/**
+ * @brief Nothing to initialize for stdout.
+ */
+extern void sk_arch_serial_init(void);
+
+#ifdef SKIRT_LINK
+/**
+ * @brief Deliver bytes arriving on stdin to sk/link.h, through SIGIO.
+ */
+extern void sk_arch_link_init(void);
+
+/**
+ * @brief Send every queued frame on stdout right away.
+ * @note Called with interrupts disabled.
+ */
+extern void sk_arch_link_tx_start(void);
+#endif /* SKIRT_LINK */
+
+#endif /* SK_SERIAL_SUPPORT */
+
+#endif /* SKIRT_ARCH_H */
@@ -0,0 +1,56 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Defines kernel types.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#ifndef SKIRT_SK_TYPES_H
+#define SKIRT_SK_TYPES_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned char sk_stack_t;
+typedef size_t sk_size_t;
+/* Saved interrupt state (true if interrupts were enabled). */
+typedef bool sk_int_state_t;
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif /* NULL */
+
+#endif /* SKIRT_SK_TYPES_H */
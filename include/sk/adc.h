@@ -0,0 +1,98 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief Continuous ADC sampling into ping-pong blocks.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * The ADC converts a sequence of channels over and over, either free running
+ * or triggered by a timer. The ADC interrupt stores each result in the block
+ * being filled and the consumer task is only woken when a block is full, it
+ * processes it while the other one fills. A block completed while the task
+ * still holds the other one is dropped and counted as an overrun.
+ */
+
+#ifndef SKIRT_ADC_H
+#define SKIRT_ADC_H
+
+#include <sk/types.h>
+#include <sk/task.h>
+
+#ifdef SKIRT_ADC
+
+/* Samples per block, the sequence length must divide it. */
+#ifndef SKIRT_ADC_BLOCK
+#define SKIRT_ADC_BLOCK 32
+#endif /* SKIRT_ADC_BLOCK */
+
+/* Longest channel sequence. */
+#define SK_ADC_SEQ_MAX 8
+
+#if SKIRT_ADC_BLOCK < 1 || SKIRT_ADC_BLOCK > 255
+#error "SKIRT_ADC_BLOCK must be between 1 and 255!"
+#endif
+
+/**
+ * @brief Start sampling a sequence of channels.
+ * @param channels Channels (MUX values) in sampling order, copied.
+ * @param count Sequence length, at most SK_ADC_SEQ_MAX and dividing
+ * SKIRT_ADC_BLOCK.
+ * @param rate Sampling rate in Hz (whole sequence counted as several samples),
+ * 0 for free running as fast as the ADC clock allows.
+ * @note Blocks hold the samples in sequence order, starting with channels[0].
+ */
+extern void sk_adc_start(const unsigned char *channels, unsigned char count,
+			 unsigned short rate);
+
+/**
+ * @brief Stop sampling, a partially filled block is lost.
+ */
+extern void sk_adc_stop(void);
+
+/**
+ * @brief Wait for the next full block, the previous one is given back.
+ * @return SKIRT_ADC_BLOCK samples, valid until the next call.
+ * @note Only one task may consume blocks.
+ */
+extern const unsigned short *sk_adc_wait(void);
+
+/**
+ * @brief Blocks dropped because the task was still busy with the other one.
+ * @return Number of blocks dropped since sk_adc_start() (saturated).
+ */
+extern unsigned short sk_adc_overruns(void);
+
+#endif /* SKIRT_ADC */
+
+#endif /* SKIRT_ADC_H */
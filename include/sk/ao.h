@@ -0,0 +1,160 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Active objects: event-driven components sharing one dispatcher task.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Each active object has an event queue and a dispatch function, a single
+ * kernel task runs dispatch functions by order of priority.
+ * Events come from a static pool and are reference counted, publishing
+ * an event to several subscribers does not copy it.
+ */
+
+#ifndef SKIRT_AO_H
+#define SKIRT_AO_H
+
+#include <sk/types.h>
+#include <sk/task.h>
+
+typedef struct sk_ao sk_ao;
+typedef struct sk_event sk_event;
+typedef void (*sk_ao_dispatch)(sk_ao *ao, const sk_event *e);
+
+/* Signals which can be subscribed to are 0 to SK_AO_SIG_MAX - 1. */
+#define SK_AO_SIG_MAX 32
+
+#ifdef SKIRT_KERNEL
+
+#ifndef SKIRT_AO_MAX
+#define SKIRT_AO_MAX 4
+#endif /* SKIRT_AO_MAX */
+
+/* Must be a power of two, one slot is always left empty. */
+#ifndef SKIRT_AO_QUEUE_SZ
+#define SKIRT_AO_QUEUE_SZ 4
+#endif /* SKIRT_AO_QUEUE_SZ */
+
+#ifndef SKIRT_EVENT_MAX
+#define SKIRT_EVENT_MAX 8
+#endif /* SKIRT_EVENT_MAX */
+
+#ifndef SKIRT_EVENT_DATA_SZ
+#define SKIRT_EVENT_DATA_SZ 4
+#endif /* SKIRT_EVENT_DATA_SZ */
+
+#ifndef SKIRT_AO_PRIO
+#define SKIRT_AO_PRIO 2
+#endif /* SKIRT_AO_PRIO */
+
+#ifndef SKIRT_AO_STACK_SZ
+#define SKIRT_AO_STACK_SZ SKIRT_TASK_STACK_SZ
+#endif /* SKIRT_AO_STACK_SZ */
+
+#if (SKIRT_AO_QUEUE_SZ & (SKIRT_AO_QUEUE_SZ - 1)) || SKIRT_AO_QUEUE_SZ > 128
+#error "SKIRT_AO_QUEUE_SZ must be a power of two and at most 128!"
+#endif
+
+struct sk_event {
+	unsigned char sig;
+	/* Number of queues holding this event, 0xff when free. */
+	volatile unsigned char refs;
+	unsigned char data[SKIRT_EVENT_DATA_SZ];
+};
+
+struct sk_ao {
+	sk_ao_dispatch dispatch;
+	void *arg;
+	short priority;
+	/* Bit n set when subscribed to signal n. */
+	unsigned long subscriptions;
+	sk_event *queue[SKIRT_AO_QUEUE_SZ];
+	volatile unsigned char head;
+	volatile unsigned char tail;
+	struct sk_ao *next;
+};
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Create an active object.
+ * @param dispatch Function called for every event received.
+ * @param priority Priority among active objects (higher is dispatched first).
+ * @param arg User pointer, available as ao->arg.
+ * @return Pointer to created active object.
+ */
+extern sk_ao *sk_ao_create(sk_ao_dispatch dispatch, short priority,
+			   void *arg);
+
+/**
+ * @brief Allocate an event from the pool.
+ * @param sig Event signal.
+ * @return Event (NULL if the pool is empty), freed once every recipient handled it.
+ * @note Safe to call from an ISR.
+ */
+extern sk_event *sk_event_new(unsigned char sig);
+
+/**
+ * @brief Post an event to an active object (FiFo).
+ * @param ao Recipient.
+ * @param e Event from sk_event_new().
+ * @return True if queued, false if the queue is full.
+ * @note Safe to call from an ISR.
+ */
+extern bool sk_ao_post(sk_ao *ao, sk_event *e);
+
+/**
+ * @brief Post an event to every active object subscribed to its signal.
+ * @param e Event from sk_event_new().
+ * @return Number of active objects the event was posted to.
+ * @note Safe to call from an ISR.
+ */
+extern unsigned char sk_ao_publish(sk_event *e);
+
+/**
+ * @brief Receive published events of a signal.
+ * @param ao Subscriber.
+ * @param sig Signal, below SK_AO_SIG_MAX.
+ */
+extern void sk_ao_subscribe(sk_ao *ao, unsigned char sig);
+
+/**
+ * @brief Stop receiving published events of a signal.
+ * @param ao Subscriber.
+ * @param sig Signal, below SK_AO_SIG_MAX.
+ */
+extern void sk_ao_unsubscribe(sk_ao *ao, unsigned char sig);
+
+#endif /* SKIRT_AO_H */
@@ -0,0 +1,93 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Deferred procedure calls (bottom halves).
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Interrupt handlers queue a function and its argument, a kernel worker task
+ * then runs them in batches so heavy processing stays out of ISRs.
+ */
+
+#ifndef SKIRT_DPC_H
+#define SKIRT_DPC_H
+
+#include <sk/types.h>
+#include <sk/task.h>
+
+typedef void (*sk_dpc_func)(void *arg);
+
+#ifdef SKIRT_KERNEL
+
+/* Must be a power of two, one slot is always left empty. */
+#ifndef SKIRT_DPC_MAX
+#define SKIRT_DPC_MAX 8
+#endif /* SKIRT_DPC_MAX */
+
+#ifndef SKIRT_DPC_PRIO
+#define SKIRT_DPC_PRIO 127
+#endif /* SKIRT_DPC_PRIO */
+
+#ifndef SKIRT_DPC_STACK_SZ
+#define SKIRT_DPC_STACK_SZ SKIRT_TASK_STACK_SZ
+#endif /* SKIRT_DPC_STACK_SZ */
+
+#if (SKIRT_DPC_MAX & (SKIRT_DPC_MAX - 1)) || SKIRT_DPC_MAX > 128
+#error "SKIRT_DPC_MAX must be a power of two and at most 128!"
+#endif
+
+typedef struct sk_dpc {
+	sk_dpc_func func;
+	void *arg;
+} sk_dpc;
+
+/**
+ * @brief Create the DPC worker task.
+ * @note Called by sk_kernel_start().
+ */
+extern void sk_dpc_init(void);
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Queue a function to be run later by the DPC worker task.
+ * @param func Function to call.
+ * @param arg Argument given to func.
+ * @return True if queued, false if the queue is full.
+ * @note Safe to call from an ISR, runs in constant time.
+ */
+extern bool sk_dpc_post(sk_dpc_func func, void *arg);
+
+#endif /* SKIRT_DPC_H */
@@ -49,6 +49,7 @@ typedef void(sk_sig_handler)(int);
 
 #ifdef SKIRT_KERNEL
 
+#ifdef SKIRT_SEM
 /* TODO: Add a task queue of tasks waiting for a semaphore, this would improve perfs. */
 typedef struct sk_sem {
 	volatile int counter;
@@ -56,23 +57,40 @@ typedef struct sk_sem {
 	char flag;
 #endif /* SKIRT_ALLOC_STATIC */
 } sk_sem;
+#endif /* SKIRT_SEM */
 
-typedef struct sk_sig {
-	int signo;
-	sk_task *waiting_tasks;
-} sk_sig;
-
+#ifdef SKIRT_MAIL
 typedef struct sk_mail {
 	const void *msg;
 	sk_task *task;
 	struct sk_mail *next;
 } sk_mail;
+#endif /* SKIRT_MAIL */
+
+#ifdef SKIRT_MSG
+typedef struct sk_msg {
+	/* Request, in the client's memory. */
+	const void *data;
+	sk_size_t len;
+	/* Client buffer the server writes its reply into. */
+	void *reply;
+	sk_size_t reply_sz;
+	/* Blocked until sk_msg_reply(). */
+	sk_task *sender;
+	struct sk_msg *next;
+	sk_size_t reply_len;
+	bool received;
+	volatile bool done;
+} sk_msg;
+#endif /* SKIRT_MSG */
 
 #else
 typedef struct sk_sem sk_sem;
 typedef struct sk_mail sk_mail;
+typedef struct sk_msg sk_msg;
 #endif /* SKIRT_KERNEL */
 
+#ifdef SKIRT_SEM
 /**************
  * Semaphores *
  **************/
@@ -105,13 +123,57 @@ extern void sk_sem_acquire(sk_sem *sem);
  * @note This will not yield to other tasks during a call.
  */
 extern bool sk_sem_try_acquire(sk_sem *sem);
+#endif /* SKIRT_SEM */
 
+#ifdef SKIRT_SIG
 /*************
  * Signals   *
  *************/
-extern void sk_sig_send(int sig);
+/* Signals are numbered 0 to SK_SIG_MAX - 1, bit n of a mask is signal n.
+ * Handlers are global: each signal has one handler for every task, only the
+ * pending and blocked masks are per task. */
+#define SK_SIG_MAX 8
+
+/**
+ * @brief Set the handler of a signal, global to every task.
+ * @param sig Signal number.
+ * @param handler Function called with the signal number, NULL to ignore it.
+ */
 extern void sk_sig_register(int sig, sk_sig_handler handler);
+/**
+ * @brief Make a signal pending for a task.
+ * @param task Recipient task.
+ * @param sig Signal number.
+ * @note Safe to call from an ISR. The handler runs in the task context the
+ * next time it is scheduled, a WAITING or SLEEPING task is not woken up. A
+ * task signalling itself runs the handler before this returns, unless the
+ * signal is blocked or interrupts are disabled.
+ */
+extern void sk_sig_send(sk_task *task, int sig);
+/**
+ * @brief Set the signals blocked for the calling task.
+ * @param mask Blocked signals, they stay pending until unblocked.
+ * @return Previously blocked signals.
+ */
+extern unsigned char sk_sig_block(unsigned char mask);
+
+#ifdef SKIRT_KERNEL
+/**
+ * @brief Check if a task must run handlers before resuming, and remember
+ * they are about to run.
+ * @note Interrupts must be disabled.
+ */
+extern bool sk_sig_need_frame(sk_task *task);
+/**
+ * @brief Run handlers of the signals pending for the current task.
+ * @note Called in the task context with interrupts disabled, handlers run
+ * with interrupts enabled.
+ */
+extern void sk_sig_run(void);
+#endif /* SKIRT_KERNEL */
+#endif /* SKIRT_SIG */
 
+#ifdef SKIRT_MAIL
 /****************
  * Mail & Boxes *
  ****************/
@@ -134,5 +196,36 @@ extern bool sk_mail_available(void);
  * @warning This does not do a copy, only pointers are exchanged!
  */
 extern const void *sk_mail_pickup(void);
+#endif /* SKIRT_MAIL */
+
+#ifdef SKIRT_MSG
+/**************************
+ * Send / Receive / Reply *
+ *************************/
+/**
+ * @brief Send a request to a server task and block until it replies.
+ * @param server Task calling sk_msg_receive().
+ * @param data Request, read in place by the server (no copy).
+ * @param len Request length.
+ * @param reply Buffer the server writes its reply into.
+ * @param reply_sz Size of the reply buffer.
+ * @return Reply length.
+ * @note The server runs at least at the caller priority until it replies.
+ */
+extern sk_size_t sk_msg_send(sk_task *server, const void *data, sk_size_t len,
+			     void *reply, sk_size_t reply_sz);
+/**
+ * @brief Block until a client sends a request (most urgent client first).
+ * @return Request, msg->data and msg->len hold it, the reply goes into
+ * msg->reply (msg->reply_sz bytes at most).
+ */
+extern sk_msg *sk_msg_receive(void);
+/**
+ * @brief Unblock the client of a received request.
+ * @param msg Request returned by sk_msg_receive().
+ * @param len Bytes written into msg->reply.
+ */
+extern void sk_msg_reply(sk_msg *msg, sk_size_t len);
+#endif /* SKIRT_MSG */
 
 #endif /* SKIRT_IPC_H */
@@ -0,0 +1,116 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Hardware interrupts registration for tasks.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A vector declared with SKIRT_IRQ() saves the interrupted task context, runs
+ * its attached handler, wakes its attached task and reschedules right away if
+ * the woken task should run first.
+ */
+
+#ifndef SKIRT_IRQ_H
+#define SKIRT_IRQ_H
+
+#include <sk/types.h>
+#include <sk/task.h>
+#include <sk/arch.h>
+
+typedef void (*sk_irq_handler)(void *arg);
+
+#ifdef SKIRT_KERNEL
+
+typedef struct sk_irq {
+	sk_irq_handler handler;
+	void *arg;
+	sk_task *task;
+	/* Interrupts received since last sk_irq_wait(). */
+	volatile unsigned char pending;
+	/* Number of interrupts needed to wake the task. */
+	unsigned char count;
+} sk_irq;
+
+/**
+ * @brief Declare an sk_irq object and bind it to an interrupt vector.
+ * @param vector Interrupt vector (ex: INT0_vect on AVR).
+ * @param name Name of the sk_irq object.
+ */
+#define SKIRT_IRQ(vector, name) \
+	sk_irq name = { 0 };    \
+	sk_arch_irq_define(vector, name)
+
+/**
+ * @brief Called by the vector wrapper, runs handler and wakes task.
+ * @param irq Interrupt that fired.
+ */
+extern void sk_irq_dispatch(sk_irq *irq);
+
+#else
+typedef struct sk_irq sk_irq;
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Attach a task to be woken by an interrupt.
+ * @param irq Interrupt declared with SKIRT_IRQ().
+ * @param task Task waiting with sk_irq_wait().
+ * @param count Number of interrupts before waking the task (at least 1).
+ */
+extern void sk_irq_attach(sk_irq *irq, sk_task *task, unsigned char count);
+
+/**
+ * @brief Attach a handler run in interrupt context.
+ * @param irq Interrupt declared with SKIRT_IRQ().
+ * @param handler Handler, called before waking the attached task.
+ * @param arg Argument given to handler.
+ * @note The handler may call sk_dpc_post() or sk_task_wake_isr().
+ */
+extern void sk_irq_attach_handler(sk_irq *irq, sk_irq_handler handler,
+				  void *arg);
+
+/**
+ * @brief Detach task and handler from an interrupt.
+ * @param irq Interrupt declared with SKIRT_IRQ().
+ */
+extern void sk_irq_detach(sk_irq *irq);
+
+/**
+ * @brief Put current task in WAITING state until the interrupt fired enough.
+ * @param irq Interrupt the task is attached to.
+ * @return Number of interrupts received since the last call.
+ */
+extern unsigned char sk_irq_wait(sk_irq *irq);
+
+#endif /* SKIRT_IRQ_H */
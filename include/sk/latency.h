@@ -0,0 +1,141 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Interrupt-disabled time and wake-up latency measurements.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Durations are measured with the preemption timer, their resolution is one
+ * timer count (16us on the ATmega328P at 16MHz).
+ */
+
+#ifndef SKIRT_LATENCY_H
+#define SKIRT_LATENCY_H
+
+#include <sk/types.h>
+#include <sk/skirt.h>
+
+/* Instrumented critical sections. */
+typedef enum sk_cs_site {
+	SK_CS_TICK, /* Preemption timer ISR, context save/restore excluded */
+	SK_CS_YIELD, /* sk_arch_yield(), context save/restore excluded */
+	SK_CS_SEM_ACQUIRE,
+	SK_CS_SEM_RELEASE,
+	SK_CS_MAIL_SEND,
+	SK_CS_MAIL_PICKUP,
+	SK_CS_MSG_SEND,
+	SK_CS_MSG_RECEIVE,
+	SK_CS_MSG_REPLY,
+	SK_CS_SITES,
+} sk_cs_site;
+
+#ifdef SKIRT_LATENCY
+
+/* Histogram buckets, bucket n counts durations in [2^(n-1), 2^n) timer counts. */
+#ifndef SKIRT_LATENCY_BUCKETS
+#define SKIRT_LATENCY_BUCKETS 8
+#endif /* SKIRT_LATENCY_BUCKETS */
+
+/**
+ * @brief Distribution of durations, in preemption timer counts.
+ * @note Counters saturate at 65535.
+ */
+typedef struct sk_latency {
+	unsigned short min;
+	unsigned short max;
+	unsigned short count;
+	unsigned short hist[SKIRT_LATENCY_BUCKETS];
+} sk_latency;
+
+#ifdef SKIRT_KERNEL
+
+/**
+ * @brief Continuous preemption timer count, wraps every 65536 counts.
+ * @note Must be called with interrupts disabled.
+ */
+extern unsigned short sk_latency_now(void);
+
+/**
+ * @brief Add a duration to a distribution.
+ * @param lat Distribution to update.
+ * @param counts Duration in preemption timer counts.
+ */
+extern void sk_latency_add(sk_latency *lat, unsigned short counts);
+
+/**
+ * @brief Mark the beginning of a critical section, right after disabling interrupts.
+ * @note Critical sections do not nest, a single start time is kept.
+ */
+extern void sk_latency_cs_enter(void);
+
+/**
+ * @brief Mark the end of a critical section, right before enabling interrupts.
+ * @param site Instrumented site.
+ */
+extern void sk_latency_cs_exit(sk_cs_site site);
+
+#define SK_CS_ENTER() sk_latency_cs_enter()
+#define SK_CS_EXIT(site) sk_latency_cs_exit(site)
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Take a snapshot of a critical section distribution.
+ * @param site Instrumented site.
+ * @param lat Filled with the distribution.
+ * @return False if site is out of range.
+ */
+extern bool sk_latency_cs_get(sk_cs_site site, sk_latency *lat);
+
+/**
+ * @brief Clear critical section and task wake-up distributions.
+ */
+extern void sk_latency_reset(void);
+
+/**
+ * @brief Print every distribution on the serial port (microseconds).
+ */
+extern void sk_latency_report(void);
+
+#else
+#define SK_CS_ENTER() \
+	do {          \
+	} while (0)
+#define SK_CS_EXIT(site) \
+	do {             \
+	} while (0)
+#endif /* SKIRT_LATENCY */
+
+#endif /* SKIRT_LATENCY_H */
@@ -0,0 +1,162 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief Framed binary link over the serial port (COBS + CRC-16).
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A frame is the channel byte, the payload and a CRC-16/CCITT-FALSE of both
+ * (big-endian), COBS encoded and terminated by 0x00. There is no other zero
+ * on the wire so a receiver resynchronizes on the next delimiter after a
+ * glitch. The TX interrupt encodes queued frames on the fly and computes the
+ * CRC while looking ahead for the next zero of each COBS group, the RX
+ * interrupt decodes and checks incoming frames and only wakes the receiving
+ * task once a whole frame is in. tools/skirt_link.py is the host side.
+ *
+ * With SKIRT_LINK, the serial port belongs to the link: SKIRT_LOG records and
+ * sk_trace_flush() go out as frames on their own channel, plain text sent
+ * with sk_serial_print() is dropped by the host as a bad frame.
+ */
+
+#ifndef SKIRT_LINK_H
+#define SKIRT_LINK_H
+
+#include <sk/types.h>
+#include <sk/skirt.h>
+#include <sk/arch.h>
+
+/* Keep in sync with tools/skirt_link.py. */
+typedef enum sk_link_channel {
+	SK_LINK_LOG = 0, /* SKIRT_LOG records, one per frame */
+	SK_LINK_TRACE = 1, /* SKIRT_TRACE records */
+	SK_LINK_STATS = 2, /* sk_link_send_stats() */
+	SK_LINK_APP = 16, /* First channel free for the application */
+} sk_link_channel;
+
+/* CRC-16/CCITT-FALSE parameters, the residue over data and CRC is 0. */
+#define SK_LINK_CRC_INIT 0xFFFF
+
+#ifdef SKIRT_LINK
+
+#ifdef SKIRT_KERNEL
+
+/* Largest payload of a frame, channel and CRC excluded. */
+#ifndef SKIRT_LINK_MTU
+#define SKIRT_LINK_MTU 64
+#endif /* SKIRT_LINK_MTU */
+
+/* Transmit queue in bytes (frames + 1 byte each), must be a power of two. */
+#ifndef SKIRT_LINK_TX_SZ
+#define SKIRT_LINK_TX_SZ 128
+#endif /* SKIRT_LINK_TX_SZ */
+
+/* Receive buffers, one is being filled while the others wait for the task. */
+#ifndef SKIRT_LINK_RX_FRAMES
+#define SKIRT_LINK_RX_FRAMES 2
+#endif /* SKIRT_LINK_RX_FRAMES */
+
+/* Channel, payload and CRC always fit in one COBS group (254 bytes). */
+#if SKIRT_LINK_MTU < 1 || SKIRT_LINK_MTU > 250
+#error "SKIRT_LINK_MTU must be between 1 and 250!"
+#endif
+
+#if (SKIRT_LINK_TX_SZ & (SKIRT_LINK_TX_SZ - 1)) || SKIRT_LINK_TX_SZ > 128 || \
+	SKIRT_LINK_TX_SZ < SKIRT_LINK_MTU + 3
+#error "SKIRT_LINK_TX_SZ must be a power of two, at most 128 and hold a frame!"
+#endif
+
+#if SKIRT_LINK_RX_FRAMES < 2
+#error "SKIRT_LINK_RX_FRAMES must be at least 2!"
+#endif
+
+/**
+ * @brief Enable the serial interrupts.
+ * @note Called by sk_kernel_start().
+ */
+extern void sk_link_init(void);
+
+/**
+ * @brief Next byte to send, called by the TX interrupt.
+ * @return Byte to send or -1 when the queue is empty (disable the interrupt).
+ */
+extern int sk_link_tx_isr(void);
+
+/**
+ * @brief Feed a received byte to the decoder, called by the RX interrupt.
+ * @param byte Byte read from the serial port.
+ */
+extern void sk_link_rx_isr(unsigned char byte);
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Queue a frame.
+ * @param channel Channel (sk_link_channel or SK_LINK_APP and above).
+ * @param data Payload.
+ * @param len Payload length (at most SKIRT_LINK_MTU).
+ * @return False if the queue was full and the frame was dropped.
+ * @note Safe to call from an ISR.
+ */
+extern bool sk_link_send(unsigned char channel, const void *data,
+			 unsigned char len);
+
+/**
+ * @brief Wait for a frame.
+ * @param channel Filled with the channel of the frame.
+ * @param buf Filled with the payload.
+ * @param size Size of buf, longer payloads are truncated.
+ * @return Payload length, even if it was truncated.
+ * @note Only one task may receive at a time.
+ */
+extern unsigned char sk_link_recv(unsigned char *channel, void *buf,
+				  unsigned char size);
+
+/**
+ * @brief Frames dropped by the receiver (bad CRC, too long or no buffer left).
+ * @return Number of frames dropped since boot (saturated).
+ */
+extern unsigned char sk_link_rx_errors(void);
+
+/**
+ * @brief Send a snapshot of every task on SK_LINK_STATS.
+ * @return False if a frame was dropped.
+ * @note Each task is 6 bytes: ID, state, priority, unused stack (16-bit LE,
+ * 0xFFFF without SKIRT_STACK_CHECK) and CPU share (0xFF without
+ * SKIRT_TASK_STATS).
+ */
+extern bool sk_link_send_stats(void);
+
+#endif /* SKIRT_LINK */
+
+#endif /* SKIRT_LINK_H */
@@ -0,0 +1,155 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Deferred logging with format strings kept in flash.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * SK_LOG() to SK_LOG4() never format anything: they copy a string ID and the
+ * raw arguments into a RAM ring buffer, a low priority kernel task sends them
+ * on the serial port. tools/skirt_log.py expands them back using the firmware
+ * ELF. A record is SK_LOG_MARK, the payload length, then the format ID
+ * (address relative to sk_log_anchor) and each argument as zigzag varints.
+ * Serial text never contains SK_LOG_MARK so both can share the port. With
+ * SKIRT_LINK, each record payload is sent as a SK_LINK_LOG frame instead.
+ */
+
+#ifndef SKIRT_LOG_H
+#define SKIRT_LOG_H
+
+#include <sk/types.h>
+#include <sk/skirt.h>
+#include <sk/arch.h>
+
+/* Keep in sync with tools/skirt_log.py. */
+#define SK_LOG_MARK 0x00
+
+#ifdef SKIRT_LOG
+
+#ifdef SKIRT_KERNEL
+
+/* Size of the ring buffer in bytes, must be a power of two. */
+#ifndef SKIRT_LOG_SZ
+#define SKIRT_LOG_SZ 64
+#endif /* SKIRT_LOG_SZ */
+
+#ifndef SKIRT_LOG_PRIO
+#define SKIRT_LOG_PRIO 1
+#endif /* SKIRT_LOG_PRIO */
+
+#ifndef SKIRT_LOG_STACK_SZ
+#define SKIRT_LOG_STACK_SZ SKIRT_TASK_STACK_SZ
+#endif /* SKIRT_LOG_STACK_SZ */
+
+#if (SKIRT_LOG_SZ & (SKIRT_LOG_SZ - 1)) || SKIRT_LOG_SZ > 128
+#error "SKIRT_LOG_SZ must be a power of two and at most 128!"
+#endif
+
+/**
+ * @brief Create the log task.
+ * @note Called by sk_kernel_start().
+ */
+extern void sk_log_init(void);
+
+#endif /* SKIRT_KERNEL */
+
+/* Most arguments a record can carry. */
+#define SK_LOG_ARGS_MAX 4
+
+/**
+ * @brief Queue a record, use the SK_LOG*() macros instead.
+ * @param fmt printf-like format stored in flash.
+ * @param nargs Number of arguments (at most SK_LOG_ARGS_MAX).
+ * @param args Arguments.
+ * @return False if the buffer was full and the record was dropped.
+ * @note Safe to call from an ISR.
+ */
+extern bool sk_log_write(const char *fmt, unsigned char nargs,
+			 const long *args);
+
+/**
+ * @brief Log a message, the format is kept in flash and expanded on the host.
+ * @note Only integers (%d, %i, %u, %x, %c with h/l modifiers) are supported.
+ */
+#define SK_LOG(fmt)                                  \
+	do {                                         \
+		sk_log_write(SK_PSTR(fmt), 0, NULL); \
+	} while (0)
+
+#define SK_LOG1(fmt, a)                                     \
+	do {                                                \
+		long sk_log_args[1] = { (long)(a) };        \
+		sk_log_write(SK_PSTR(fmt), 1, sk_log_args); \
+	} while (0)
+
+#define SK_LOG2(fmt, a, b)                                      \
+	do {                                                    \
+		long sk_log_args[2] = { (long)(a), (long)(b) }; \
+		sk_log_write(SK_PSTR(fmt), 2, sk_log_args);     \
+	} while (0)
+
+#define SK_LOG3(fmt, a, b, c)                                 \
+	do {                                                  \
+		long sk_log_args[3] = { (long)(a), (long)(b), \
+					(long)(c) };          \
+		sk_log_write(SK_PSTR(fmt), 3, sk_log_args);   \
+	} while (0)
+
+#define SK_LOG4(fmt, a, b, c, d)                                \
+	do {                                                    \
+		long sk_log_args[4] = { (long)(a), (long)(b),   \
+					(long)(c), (long)(d) }; \
+		sk_log_write(SK_PSTR(fmt), 4, sk_log_args);     \
+	} while (0)
+
+#else
+#define SK_LOG(fmt) \
+	do {        \
+	} while (0)
+#define SK_LOG1(fmt, a) \
+	do {            \
+	} while (0)
+#define SK_LOG2(fmt, a, b) \
+	do {               \
+	} while (0)
+#define SK_LOG3(fmt, a, b, c) \
+	do {                  \
+	} while (0)
+#define SK_LOG4(fmt, a, b, c, d) \
+	do {                     \
+	} while (0)
+#endif /* SKIRT_LOG */
+
+#endif /* SKIRT_LOG_H */
@@ -0,0 +1,105 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Statistical profiler sampled by the preemption timer.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Every tick records the address interrupted in the running task into a small
+ * histogram keyed by (task, address bin). sk_profile_dump() prints it on the
+ * serial port, use tools/skirt_profile.py with the firmware ELF to get a
+ * per-function profile.
+ */
+
+#ifndef SKIRT_PROFILE_H
+#define SKIRT_PROFILE_H
+
+#include <sk/types.h>
+#include <sk/skirt.h>
+#include <sk/task.h>
+
+#ifdef SKIRT_PROFILE
+
+#ifdef SKIRT_KERNEL
+
+/* Number of histogram entries, 5 bytes each on AVR. When full, the coldest
+ * entry is replaced and its samples are counted as dropped. */
+#ifndef SKIRT_PROFILE_SZ
+#define SKIRT_PROFILE_SZ 32
+#endif /* SKIRT_PROFILE_SZ */
+
+/* Code addresses are grouped in bins of 2^SKIRT_PROFILE_SHIFT words. */
+#ifndef SKIRT_PROFILE_SHIFT
+#define SKIRT_PROFILE_SHIFT 2
+#endif /* SKIRT_PROFILE_SHIFT */
+
+#if SKIRT_PROFILE_SZ > 255
+#error "SKIRT_PROFILE_SZ must be at most 255!"
+#endif
+
+#if defined(__AVR_3_BYTE_PC__) && SKIRT_PROFILE_SHIFT < 1
+#error "SKIRT_PROFILE_SHIFT must be at least 1 with a 3-byte PC (17-bit word addresses)!"
+#endif
+
+typedef struct sk_profile_bin {
+	unsigned short bin;
+	unsigned short count;
+	sk_tid tid;
+} sk_profile_bin;
+
+/**
+ * @brief Record one sample, called by the preemption timer.
+ * @param pc Interrupted code word address.
+ * @param task Interrupted task.
+ */
+extern void sk_profile_sample(unsigned long pc, sk_task *task);
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Print the histogram on the serial port.
+ * @note One "tid address count" line per entry (byte addresses), then the
+ * number of samples dropped out of all those taken, with their share.
+ */
+extern void sk_profile_dump(void);
+
+/**
+ * @brief Clear the histogram.
+ */
+extern void sk_profile_reset(void);
+
+#endif /* SKIRT_PROFILE */
+
+#endif /* SKIRT_PROFILE_H */
@@ -0,0 +1,224 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Stackless tasks (protothreads) sharing a single stack.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A protothread is a function resumed where it last blocked, local variables
+ * are not kept between calls (use static ones or the arg pointer).
+ * All protothreads are run by one kernel task, by order of priority. It sleeps
+ * while they are all blocked, call sk_pt_wake() after changing a condition
+ * waited for by SK_PT_WAIT_UNTIL().
+ *
+ * ```c
+ * char blink(sk_pt *pt)
+ * {
+ *	SK_PT_BEGIN(pt);
+ *	for (;;) {
+ *		SK_PT_WAIT_SEM(pt, sem);
+ *		toggle_led();
+ *		SK_PT_SLEEP(pt, 10);
+ *	}
+ *	SK_PT_END(pt);
+ * }
+ * ```
+ */
+
+#ifndef SKIRT_PT_H
+#define SKIRT_PT_H
+
+#include <sk/types.h>
+#include <sk/task.h>
+#include <sk/ipc.h>
+
+typedef struct sk_pt sk_pt;
+typedef char (*sk_pt_func)(sk_pt *pt);
+
+/* Values returned by a protothread function. */
+#define SK_PT_WAITING 0
+#define SK_PT_YIELDED 1
+#define SK_PT_EXITED 2
+
+#ifdef SKIRT_KERNEL
+
+#ifndef SKIRT_PT_MAX
+#define SKIRT_PT_MAX 8
+#endif /* SKIRT_PT_MAX */
+
+#ifndef SKIRT_PT_PRIO
+#define SKIRT_PT_PRIO 1
+#endif /* SKIRT_PT_PRIO */
+
+#ifndef SKIRT_PT_STACK_SZ
+#define SKIRT_PT_STACK_SZ SKIRT_TASK_STACK_SZ
+#endif /* SKIRT_PT_STACK_SZ */
+
+struct sk_pt {
+	sk_pt_func func;
+	void *arg;
+	/* Local continuation, line where the protothread blocked. */
+	unsigned short lc;
+	short priority;
+	/* Tick count at which SK_PT_SLEEP() ends. */
+	sk_size_t wake;
+	bool sleeping;
+	sk_mail *mailbox;
+	struct sk_pt *next;
+};
+
+/* Runs protothreads, also owner of their mails. */
+extern sk_task *pt_runner;
+
+/**
+ * @brief Wake the runner when the earliest SK_PT_SLEEP() ends.
+ * @note Called by the preemption timer with interrupts disabled.
+ */
+extern void sk_pt_tick(void);
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Start a protothread.
+ */
+#define SK_PT_BEGIN(pt)         \
+	switch ((pt)->lc) {     \
+	case 0:
+
+/**
+ * @brief End a protothread, it is then destroyed.
+ */
+#define SK_PT_END(pt)             \
+	}                         \
+	(pt)->lc = 0;             \
+	return SK_PT_EXITED
+
+/**
+ * @brief Block until cond is true.
+ */
+#define SK_PT_WAIT_UNTIL(pt, cond)                \
+	do {                                      \
+		(pt)->lc = __LINE__;              \
+		SK_FALLTHROUGH;                   \
+	case __LINE__:                            \
+		if (!(cond)) {                    \
+			return SK_PT_WAITING;     \
+		}                                 \
+	} while (0)
+
+/**
+ * @brief Give other protothreads a chance to run, the next ones in priority
+ * order run before this one is resumed.
+ */
+#define SK_PT_YIELD(pt)                           \
+	do {                                      \
+		(pt)->lc = __LINE__;              \
+		return SK_PT_YIELDED;             \
+	case __LINE__:;                           \
+	} while (0)
+
+/**
+ * @brief Exit a protothread, it is then destroyed.
+ */
+#define SK_PT_EXIT(pt)                    \
+	do {                              \
+		(pt)->lc = 0;             \
+		return SK_PT_EXITED;      \
+	} while (0)
+
+/**
+ * @brief Block for at least ticks preemption timer ticks.
+ */
+#define SK_PT_SLEEP(pt, ticks)                                        \
+	do {                                                          \
+		(pt)->wake = sk_kernel_ticks() + (ticks);             \
+		(pt)->sleeping = true;                                \
+		SK_PT_WAIT_UNTIL(pt, sk_pt_elapsed((pt)->wake));      \
+		(pt)->sleeping = false;                               \
+	} while (0)
+
+/**
+ * @brief Block until the semaphore is acquired.
+ */
+#define SK_PT_WAIT_SEM(pt, sem) SK_PT_WAIT_UNTIL(pt, sk_sem_try_acquire(sem))
+
+/**
+ * @brief Block until a mail is available, retrieve it with sk_pt_mail_pickup().
+ */
+#define SK_PT_WAIT_MAIL(pt) SK_PT_WAIT_UNTIL(pt, sk_pt_mail_available(pt))
+
+/**
+ * @brief Create a protothread.
+ * @param func Protothread function.
+ * @param priority Priority among protothreads (higher runs first).
+ * @param arg User pointer, available as pt->arg.
+ * @return Pointer to created protothread.
+ */
+extern sk_pt *sk_pt_create(sk_pt_func func, short priority, void *arg);
+
+/**
+ * @brief Check if a tick count was reached.
+ * @param wake Tick count.
+ * @return True if sk_kernel_ticks() is past wake.
+ */
+extern bool sk_pt_elapsed(sk_size_t wake);
+
+/**
+ * @brief Make the runner check blocked protothreads again.
+ * @note Safe to call from an ISR, semaphore releases and protothread mails
+ * already call it.
+ */
+extern void sk_pt_wake(void);
+
+/**
+ * @brief Send a mail to a protothread (FiFo).
+ * @param pt Recipient protothread.
+ * @param msg Pointer to data.
+ * @return True if mail was sent, False if not.
+ */
+extern bool sk_pt_mail_send(sk_pt *pt, const void *msg);
+
+/**
+ * @brief Check if a mail is available for a protothread.
+ */
+extern bool sk_pt_mail_available(sk_pt *pt);
+
+/**
+ * @brief Retrieve queued mail of a protothread (FiFo).
+ * @return Mail's content (NULL if none).
+ */
+extern const void *sk_pt_mail_pickup(sk_pt *pt);
+
+#endif /* SKIRT_PT_H */
@@ -73,6 +73,35 @@ SK_INLINE void sk_serial_print(const char *str)
 	}
 }
 
+/**
+ * @brief Print a string stored in flash (see SK_PSTR()) on the serial device.
+ */
+SK_INLINE void sk_serial_print_P(const char *str)
+{
+	char c;
+	while ((c = (char)sk_arch_pgm_read_byte(str)) != '\0') {
+		sk_serial_putc(c);
+		str++;
+	}
+}
+
+/**
+ * @brief Print an unsigned number in decimal on the serial device.
+ */
+SK_INLINE void sk_serial_print_uint(unsigned long n)
+{
+	/* Up to 20 digits on 64-bit hosts, 3 per byte is always enough. */
+	char buf[sizeof(unsigned long) * 3];
+	unsigned char i = 0;
+	do {
+		buf[i++] = (char)('0' + n % 10);
+		n /= 10;
+	} while (n);
+	while (i) {
+		sk_serial_putc(buf[--i]);
+	}
+}
+
 #endif /* SK_SERIAL_SUPPORT */
 
 #endif /* SKIRT_SERIAL_H */
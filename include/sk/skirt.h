@@ -42,15 +42,19 @@ knowledge of the CeCILL license and that you accept its terms.
 #ifndef SKIRT_SKIRT_H
 #define SKIRT_SKIRT_H
 
+#include <sk/config.h>
+#include <sk/types.h>
+
 /* Kernel-only symbols. */
 #ifdef SKIRT_KERNEL
 
 #define SK_STR2(x) #x
 #define SK_STR(x) SK_STR2(x)
-#define SK_PANIC(msg)                  \
-	do {                           \
-		sk_arch_disable_int(); \
-		sk_arch_panic(msg);    \
+/* msg must be a string literal, it is kept in flash (see SK_PSTR()). */
+#define SK_PANIC(msg)                        \
+	do {                                 \
+		sk_arch_disable_int();       \
+		sk_arch_panic(SK_PSTR(msg)); \
 	} while (0)
 
 #ifdef SKIRT_DEBUG
@@ -82,13 +86,20 @@ knowledge of the CeCILL license and that you accept its terms.
 #define SK_INLINE __attribute__((always_inline)) inline
 #define SK_HOT __attribute__((hot))
 #define SK_NOOPTI __attribute__((optimize("O0")))
+#if __GNUC__ >= 7
+#define SK_FALLTHROUGH __attribute__((fallthrough))
+#else
+#define SK_FALLTHROUGH \
+	do {           \
+	} while (0)
+#endif /* __GNUC__ >= 7 */
 #else
 #error "FIXME: Currently only supporting GCC!."
 #endif
 
 /**
  * @brief Kernel panic!
- * @param msg Message to display on debugging port.
+ * @param msg Message to display on debugging port, stored in flash.
  */
 extern void sk_arch_panic(const char *msg) SK_NORETURN;
 
@@ -100,4 +111,10 @@ extern void sk_arch_panic(const char *msg) SK_NORETURN;
  */
 extern void sk_kernel_start(void);
 
+/**
+ * @brief Number of preemption timer ticks since the kernel started.
+ * @return Tick count, wraps around.
+ */
+extern sk_size_t sk_kernel_ticks(void);
+
 #endif /* SKIRT_SKIRT_H */
@@ -0,0 +1,121 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief Interrupt-driven SPI master driver.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A transfer shifts a block out and in, one byte per SPI interrupt, with the
+ * chip select of its device held low for the whole block. sk_spi_submit()
+ * only queues it so the task can prepare the next block meanwhile,
+ * sk_spi_wait() sleeps until it is over. Queued transfers start right from
+ * the interrupt, back to back.
+ */
+
+#ifndef SKIRT_SPI_H
+#define SKIRT_SPI_H
+
+#include <sk/types.h>
+#include <sk/task.h>
+
+/* Device flags, ORed with the SPI mode (0 to 3). */
+#define SK_SPI_LSB_FIRST 0x04
+
+/* Transfer flags. */
+/* Leave CS low after the block, only this device may use the bus until a
+ * transfer without this flag ends. */
+#define SK_SPI_KEEP_CS 0x01
+
+typedef struct sk_spi_dev {
+	volatile unsigned char *cs_port;
+	unsigned char cs_mask;
+	/* Clock and mode settings, loaded before each transfer. */
+	unsigned char spcr;
+	unsigned char spsr;
+} sk_spi_dev;
+
+/* Owned by the driver from sk_spi_submit() until sk_spi_wait() returns. */
+typedef struct sk_spi_xfer {
+	sk_spi_dev *dev;
+	/* Bytes to send, 0xFF is sent if NULL. */
+	const unsigned char *tx;
+	/* Filled with the bytes received, dropped if NULL. */
+	unsigned char *rx;
+	unsigned short len;
+	unsigned char flags;
+	volatile bool done;
+	sk_task *volatile task;
+	struct sk_spi_xfer *next;
+} sk_spi_xfer;
+
+#ifdef SKIRT_SPI
+
+/**
+ * @brief Enable the SPI master (SCK, MOSI and SS as outputs).
+ */
+extern void sk_spi_init(void);
+
+/**
+ * @brief Describe a device on the bus, its CS pin is set as a high output.
+ * @param dev Device.
+ * @param cs_port PORTx register of the chip select pin (ex: &PORTB).
+ * @param cs_bit Bit of the chip select pin.
+ * @param mode SPI mode (0 to 3), ORed with SK_SPI_LSB_FIRST if needed.
+ * @param div SCK divider from F_CPU: 2, 4, 8, 16, 32, 64 or 128.
+ */
+extern void sk_spi_dev_init(sk_spi_dev *dev, volatile unsigned char *cs_port,
+			    unsigned char cs_bit, unsigned char mode,
+			    unsigned char div);
+
+/**
+ * @brief Queue a transfer and return right away.
+ * @param xfer Transfer, dev, tx, rx, len (at least 1) and flags must be set.
+ */
+extern void sk_spi_submit(sk_spi_xfer *xfer);
+
+/**
+ * @brief Sleep until a submitted transfer is over.
+ * @param xfer Transfer given to sk_spi_submit().
+ */
+extern void sk_spi_wait(sk_spi_xfer *xfer);
+
+/**
+ * @brief Submit a transfer and wait for it.
+ * @param xfer Transfer, see sk_spi_submit().
+ */
+extern void sk_spi_transfer(sk_spi_xfer *xfer);
+
+#endif /* SKIRT_SPI */
+
+#endif /* SKIRT_SPI_H */
@@ -43,9 +43,14 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include <sk/skirt.h>
 #include <sk/types.h>
+#include <sk/latency.h>
 
 typedef void (*sk_task_func)(void);
 
+/* Task ID, index in the task table. */
+typedef unsigned char sk_tid;
+#define SK_TID_NONE ((sk_tid)0xff)
+
 #ifdef SKIRT_KERNEL
 
 #ifndef SKIRT_PREEMPT_TIME
@@ -64,46 +69,198 @@ typedef void (*sk_task_func)(void);
 
 #endif /* SKIRT_ALLOC_STATIC*/
 
+/* Stacks are painted with this byte to measure their peak usage. */
+#ifndef SKIRT_STACK_PATTERN
+#define SKIRT_STACK_PATTERN 0xA5
+#endif /* SKIRT_STACK_PATTERN */
+
 /* Forward declaration for Mail structure */
 typedef struct sk_mail sk_mail;
+/* Forward declaration for Message structure */
+typedef struct sk_msg sk_msg;
+
+#if SKIRT_TASK_MAX > 255
+#error "SKIRT_TASK_MAX must be at most 255 (8-bit IDs, 0xff is SK_TID_NONE)!"
+#endif
+
+/* Kernel tasks use slots of the task table (idle is always there), the
+ * others are left to the application. */
+#ifdef SKIRT_DPC
+#define SK_DPC_TASKS 1
+#else
+#define SK_DPC_TASKS 0
+#endif /* SKIRT_DPC */
+#ifdef SKIRT_TIMER
+#define SK_TIMER_TASKS 1
+#else
+#define SK_TIMER_TASKS 0
+#endif /* SKIRT_TIMER */
+#ifdef SKIRT_PT
+#define SK_PT_TASKS 1
+#else
+#define SK_PT_TASKS 0
+#endif /* SKIRT_PT */
+#ifdef SKIRT_AO
+#define SK_AO_TASKS 1
+#else
+#define SK_AO_TASKS 0
+#endif /* SKIRT_AO */
+#ifdef SKIRT_LOG
+#define SK_LOG_TASKS 1
+#else
+#define SK_LOG_TASKS 0
+#endif /* SKIRT_LOG */
+#define SK_KERNEL_TASKS                                                 \
+	(1 + SK_DPC_TASKS + SK_TIMER_TASKS + SK_PT_TASKS + SK_AO_TASKS + \
+	 SK_LOG_TASKS)
 
 typedef enum sk_state { RUNNING, READY, WAITING, SLEEPING } sk_state;
 
+#ifdef SKIRT_TASK_STATS
+
+/* Number of ticks over which CPU shares are computed. */
+#ifndef SKIRT_STATS_WINDOW
+#define SKIRT_STATS_WINDOW 100
+#endif /* SKIRT_STATS_WINDOW */
+
 typedef struct sk_counter {
 	/* Those counters are never reset. */
-	sk_size_t since_creation;
-	sk_size_t running;
-	sk_size_t waiting;
+	unsigned long since_creation;
+	unsigned long running;
+	unsigned long waiting;
+	/* Times the task was switched in. */
+	unsigned long switches;
+	/* Preemption timer counts spent running. */
+	unsigned long runtime;
+	/* Runtime at the beginning of the current window. */
+	unsigned long window_start;
 
 	/* Those counters are reset when changing state. */
-	sk_size_t sleeping;
-	sk_size_t ready;
+	unsigned long ready;
+
+	/* Share of the CPU over the last complete window (percent). */
+	unsigned char share;
 } sk_counter;
+#endif /* SKIRT_TASK_STATS */
 
+/* Fields are ordered to avoid padding on 16 and 32-bit architectures. */
 typedef struct sk_task {
 	sk_stack_t *stack;
 	sk_stack_t *sp;
+#ifdef SKIRT_MAIL
+	sk_mail *mailbox;
+#endif /* SKIRT_MAIL */
+#ifdef SKIRT_MSG
+	/* Clients blocked on this task, most urgent first. */
+	sk_msg *msg_queue;
+	/* Server this task is blocked on. */
+	struct sk_task *msg_server;
+#endif /* SKIRT_MSG */
 	sk_size_t stack_sz;
-	sk_state state;
+	/* Ticks left before a SLEEPING task is READY. */
+	sk_size_t sleeping;
+#ifdef SKIRT_TASK_STATS
 	sk_counter counter;
-	short priority;
-	struct sk_task *next;
-	sk_mail *mailbox;
+#endif /* SKIRT_TASK_STATS */
+#ifdef SKIRT_LATENCY
+	/* Time between becoming READY and being switched in. */
+	sk_latency wake;
+	unsigned short woken_at;
+#endif /* SKIRT_LATENCY */
+	unsigned char state; /* sk_state */
+	signed char priority;
+	sk_tid next;
+#ifdef SKIRT_MSG
+	/* Priority without the one inherited from clients. */
+	signed char base_priority;
+	bool msg_receiving;
+#endif /* SKIRT_MSG */
+#ifdef SKIRT_SIG
+	volatile unsigned char sig_pending;
+	unsigned char sig_blocked;
+	/* Set when the handlers will run before the saved context. */
+	bool sig_frame;
+#endif /* SKIRT_SIG */
+#ifdef SKIRT_LATENCY
+	/* Set when woken_at holds a pending wake-up. */
+	bool woken;
+#endif /* SKIRT_LATENCY */
 } sk_task;
 
 /**
- * @brief Change which process is currently running.
+ * @brief Update per-tick counters (sleeps, statistics) and elect the next task.
+ * @note Called by the preemption timer only, yields use sk_task_schedule().
  */
 extern void sk_task_switch(void);
 
+/**
+ * @brief Elect the next task to run without updating counters.
+ */
+extern void sk_task_schedule(void);
+
+/**
+ * @brief Make a WAITING task READY from an ISR.
+ * @param task Task to wake.
+ * @note Requests a reschedule if the task should run before the current one,
+ * it is honored when leaving an ISR declared with SKIRT_IRQ().
+ */
+extern void sk_task_wake_isr(sk_task *task);
+
 #else /* Provide hidden definitions. */
 typedef struct sk_task sk_task;
 #endif /* SKIRT_KERNEL */
 
+#ifdef SKIRT_TASK_STATS
+/**
+ * @brief Snapshot of a task statistics.
+ */
+typedef struct sk_task_stats {
+	/* Share of the CPU over the last SKIRT_STATS_WINDOW ticks (percent). */
+	unsigned char cpu_percent;
+	/* Total time spent running. */
+	unsigned long long runtime_us;
+	/* Times the task was switched in. */
+	unsigned long switches;
+	/* Ticks spent in each state. */
+	unsigned long running;
+	unsigned long waiting;
+	unsigned long ready;
+	unsigned long since_creation;
+} sk_task_stats;
+
+/**
+ * @brief Take a snapshot of a task statistics.
+ * @param task Task to inspect.
+ * @param stats Filled with the task statistics.
+ */
+extern void sk_task_stats_get(sk_task *task, sk_task_stats *stats);
+
+/**
+ * @brief Share of the CPU spent in the idle task.
+ * @return Idle percentage over the last SKIRT_STATS_WINDOW ticks.
+ */
+extern unsigned char sk_kernel_idle_percent(void);
+#endif /* SKIRT_TASK_STATS */
+
+#ifdef SKIRT_LATENCY
+/**
+ * @brief Take a snapshot of a task wake-up latency (READY to RUNNING).
+ * @param task Task to inspect.
+ * @param lat Filled with the distribution.
+ */
+extern void sk_task_latency_get(sk_task *task, sk_latency *lat);
+
+/**
+ * @brief Clear a task wake-up latency distribution.
+ * @param task Task to reset.
+ */
+extern void sk_task_latency_reset(sk_task *task);
+#endif /* SKIRT_LATENCY */
+
 /**
  * @brief Create a task with a static stack.
  * @param func Task function.
- * @param priority Task priority.
+ * @param priority Task priority (-128 to 127).
  * @param stack Allocated memory where the stack will be stored.
  * @param stack_size Size of the stack.
  * @return Pointer to created task.
@@ -112,6 +269,26 @@ typedef struct sk_task sk_task;
 extern sk_task *sk_task_create_static(sk_task_func, short priority, void *stack,
 				      sk_size_t stack_sz);
 
+/**
+ * @brief Get the ID of a task.
+ * @param task Task created with sk_task_create_static().
+ * @return Task ID.
+ */
+extern sk_tid sk_task_id(sk_task *task);
+
+/**
+ * @brief Get a task from its ID.
+ * @param tid Task ID.
+ * @return Task (NULL if there is no such task).
+ */
+extern sk_task *sk_task_from_id(sk_tid tid);
+
+/**
+ * @brief Get the ID of the calling task.
+ * @return Task ID.
+ */
+extern sk_tid sk_task_self(void);
+
 /**
  * @brief Kill a running task.
  * @param task Task to be killed
@@ -129,6 +306,20 @@ extern void sk_task_exit(void);
  */
 extern void sk_task_sleep(sk_size_t time_ms);
 
+#ifdef SKIRT_STACK_CHECK
+/**
+ * @brief Number of stack bytes never used by a task since its creation.
+ * @param task Task to check.
+ * @return Untouched stack bytes (0 means the stack was entirely used).
+ */
+extern sk_size_t sk_task_stack_unused(sk_task *task);
+
+/**
+ * @brief Print peak stack usage of every task on the serial port.
+ */
+extern void sk_task_stack_report(void);
+#endif /* SKIRT_STACK_CHECK */
+
 /**
  * @brief Wake-up a waiting task.
  * @param task Task in WAITING state.
@@ -136,7 +327,10 @@ extern void sk_task_sleep(sk_size_t time_ms);
 extern void sk_task_awake(sk_task *task);
 /**
  * @brief Put current task (caller) in WAITING state.
- * @note Only "sk_task_awake" will change its state!
+ * @note Only sk_task_awake() or sk_task_wake_isr() will change its state.
+ * May be called with interrupts disabled: WAITING is set before they are
+ * enabled again, so a wake-up from an ISR cannot be lost between the
+ * caller's check and the wait. Interrupts are enabled on return.
  */
 extern void sk_task_await(void);
 
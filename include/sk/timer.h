@@ -0,0 +1,127 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Software timers run by a kernel service task.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Active timers are kept in a delta list ordered by expiry, each one storing
+ * the ticks left after the previous one: the preemption tick only decrements
+ * the first entry and unlinks the expired ones. Their callbacks are then run
+ * in a batch by a single kernel task, with interrupts enabled.
+ */
+
+#ifndef SKIRT_TIMER_H
+#define SKIRT_TIMER_H
+
+#include <sk/types.h>
+#include <sk/task.h>
+
+typedef void (*sk_timer_func)(void *arg);
+
+#ifdef SKIRT_KERNEL
+
+#ifndef SKIRT_TIMER_MAX
+#define SKIRT_TIMER_MAX 8
+#endif /* SKIRT_TIMER_MAX */
+
+#ifndef SKIRT_TIMER_PRIO
+#define SKIRT_TIMER_PRIO 126
+#endif /* SKIRT_TIMER_PRIO */
+
+#ifndef SKIRT_TIMER_STACK_SZ
+#define SKIRT_TIMER_STACK_SZ SKIRT_TASK_STACK_SZ
+#endif /* SKIRT_TIMER_STACK_SZ */
+
+typedef struct sk_timer {
+	sk_timer_func func;
+	void *arg;
+	/* Ticks after the previous active timer. */
+	sk_size_t delta;
+	/* Reload value, 0 for one-shot timers. */
+	sk_size_t period;
+	/* Active list, ordered by expiry. */
+	struct sk_timer *next;
+	/* Expired timers waiting for their callback. */
+	struct sk_timer *next_fired;
+	unsigned char state;
+	bool fired;
+} sk_timer;
+
+/**
+ * @brief Create the timer service task.
+ * @note Called by sk_kernel_start().
+ */
+extern void sk_timer_init(void);
+
+/**
+ * @brief Advance active timers by one tick.
+ * @note Called by the preemption timer with interrupts disabled.
+ */
+extern void sk_timer_tick(void);
+
+#else
+typedef struct sk_timer sk_timer;
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Create a stopped timer.
+ * @param func Function called by the service task on expiry.
+ * @param arg Argument given to func.
+ * @return Pointer to created timer.
+ */
+extern sk_timer *sk_timer_create(sk_timer_func func, void *arg);
+
+/**
+ * @brief Stop a timer and give it back to the pool.
+ */
+extern void sk_timer_destroy(sk_timer *timer);
+
+/**
+ * @brief (Re)start a timer, a callback still pending is dropped.
+ * @param ticks Preemption ticks until the first expiry, at least 1.
+ * @param period Ticks between later expiries, 0 for a one-shot timer.
+ * @note Runs in time linear in the number of active timers.
+ */
+extern void sk_timer_start(sk_timer *timer, sk_size_t ticks,
+			   sk_size_t period);
+
+/**
+ * @brief Stop a timer, a callback still pending is dropped.
+ * @return True if the timer was active or its callback pending.
+ */
+extern bool sk_timer_stop(sk_timer *timer);
+
+#endif /* SKIRT_TIMER_H */
@@ -0,0 +1,162 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Publish/subscribe topics with multicast delivery.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A publisher posts a pointer to a topic once, whatever the number of
+ * subscribers. Each subscription either follows the latest value (nothing is
+ * stored, values published in between are skipped) or queues every value in
+ * a ring provided by the subscriber. Values carry the topic sequence number,
+ * gaps show what a subscriber missed. Waiting subscribers are woken in the
+ * same pass that delivers the value.
+ */
+
+#ifndef SKIRT_TOPIC_H
+#define SKIRT_TOPIC_H
+
+#include <sk/types.h>
+#include <sk/task.h>
+
+typedef struct sk_topic sk_topic;
+
+/* Value queued for a subscriber. */
+typedef struct sk_topic_entry {
+	const void *value;
+	unsigned short seq;
+} sk_topic_entry;
+
+typedef struct sk_topic_sub {
+	sk_topic *topic;
+	sk_task *task;
+	struct sk_topic_sub *next;
+	/* Ring of values for queued delivery, NULL to follow the latest. */
+	sk_topic_entry *queue;
+	unsigned char mask;
+	volatile unsigned char head;
+	volatile unsigned char tail;
+	/* Values dropped because the ring was full (saturated). */
+	volatile unsigned char lost;
+	/* Sequence number of the last value taken. */
+	unsigned short seq;
+	volatile bool waiting;
+} sk_topic_sub;
+
+#ifdef SKIRT_KERNEL
+
+#ifndef SKIRT_TOPIC_MAX
+#define SKIRT_TOPIC_MAX 4
+#endif /* SKIRT_TOPIC_MAX */
+
+struct sk_topic {
+	const void *value;
+	sk_topic_sub *subs;
+	volatile unsigned short seq;
+	bool used;
+};
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Create a topic.
+ * @return Pointer to created topic.
+ */
+extern sk_topic *sk_topic_create(void);
+
+/**
+ * @brief Follow the latest value published on a topic.
+ * @param sub Subscription, owned by the caller until unsubscribed.
+ * @note Only values published after subscribing are taken.
+ */
+extern void sk_topic_subscribe(sk_topic *topic, sk_topic_sub *sub);
+
+/**
+ * @brief Receive every value published on a topic, in order.
+ * @param sub Subscription, owned by the caller until unsubscribed.
+ * @param queue Ring of size entries (power of two, one is kept empty).
+ * @param size Number of entries, at most 128.
+ */
+extern void sk_topic_subscribe_queue(sk_topic *topic, sk_topic_sub *sub,
+				     sk_topic_entry *queue,
+				     unsigned char size);
+
+/**
+ * @brief Stop receiving values, the subscription can be reused.
+ */
+extern void sk_topic_unsubscribe(sk_topic_sub *sub);
+
+/**
+ * @brief Publish a value to every subscriber.
+ * @param value Pointer given to subscribers, it is not copied.
+ * @note Safe to call from an ISR, runs in time linear in the number of
+ * subscribers. Called by a task, it yields if a woken subscriber must run
+ * first.
+ */
+extern void sk_topic_publish(sk_topic *topic, const void *value);
+
+/**
+ * @brief Take the next value without blocking.
+ * @param seq If not NULL, set to the sequence number of the value.
+ * @return Next value (latest or oldest queued), NULL if there is none.
+ */
+extern const void *sk_topic_try_take(sk_topic_sub *sub, unsigned short *seq);
+
+/**
+ * @brief Block until a value is available and take it.
+ * @param seq If not NULL, set to the sequence number of the value.
+ * @return Next value (latest or oldest queued).
+ * @note A subscription belongs to a single task.
+ */
+extern const void *sk_topic_take(sk_topic_sub *sub, unsigned short *seq);
+
+/**
+ * @brief Check a value taken from a latest-value subscription was not
+ * replaced since, to detect a torn read after copying it.
+ * @param seq Sequence number given with the value.
+ * @return True if nothing was published since.
+ * @note Only works if the publisher fills a buffer after publishing the one
+ * it replaces, with at least two buffers used in turn.
+ */
+extern bool sk_topic_valid(sk_topic_sub *sub, unsigned short seq);
+
+/**
+ * @brief Latest value published on a topic, without subscribing.
+ * @param seq If not NULL, set to its sequence number (0 if none).
+ * @return Latest value, NULL if nothing was published yet.
+ */
+extern const void *sk_topic_latest(sk_topic *topic, unsigned short *seq);
+
+#endif /* SKIRT_TOPIC_H */
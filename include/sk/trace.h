@@ -0,0 +1,121 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Binary trace of scheduler, IPC and interrupt events.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Records are 4 bytes (event, argument, 16-bit timestamp in preemption timer
+ * counts) stored in a RAM ring buffer, the oldest ones are overwritten when
+ * it is full. sk_trace_flush() sends them on the serial port, use
+ * tools/skirt_trace.py to turn them into a timeline. With SKIRT_LINK they are
+ * sent as SK_LINK_TRACE frames, tools/skirt_link.py --trace saves them in the
+ * format skirt_trace.py reads.
+ */
+
+#ifndef SKIRT_TRACE_H
+#define SKIRT_TRACE_H
+
+#include <sk/types.h>
+#include <sk/skirt.h>
+
+/* Keep in sync with tools/skirt_trace.py. */
+typedef enum sk_trace_event {
+	SK_TRACE_SWITCH = 1, /* arg: ID of the task switched in */
+	SK_TRACE_WAKE, /* arg: ID of the task made READY */
+	SK_TRACE_ISR_ENTER, /* arg: low byte of the sk_irq address */
+	SK_TRACE_ISR_EXIT, /* arg: low byte of the sk_irq address */
+	SK_TRACE_SEM_ACQUIRE, /* arg: semaphore index */
+	SK_TRACE_SEM_BLOCK, /* arg: semaphore index */
+	SK_TRACE_SEM_RELEASE, /* arg: semaphore index */
+	SK_TRACE_MAIL_SEND, /* arg: ID of the recipient */
+	SK_TRACE_MAIL_PICKUP, /* arg: ID of the recipient */
+	SK_TRACE_LOST, /* arg: records overwritten since last flush (saturated) */
+	SK_TRACE_MSG_SEND, /* arg: ID of the server */
+	SK_TRACE_MSG_RECEIVE, /* arg: ID of the client */
+	SK_TRACE_MSG_REPLY, /* arg: ID of the client */
+	SK_TRACE_USER = 0x80, /* Free for applications */
+} sk_trace_event;
+
+/* Synchronization header sent before every flushed block. */
+#define SK_TRACE_SYNC0 0xA5
+#define SK_TRACE_SYNC1 0x5A
+
+#ifdef SKIRT_TRACE
+
+#ifdef SKIRT_KERNEL
+
+/* Number of records, must be a power of two. */
+#ifndef SKIRT_TRACE_SZ
+#define SKIRT_TRACE_SZ 32
+#endif /* SKIRT_TRACE_SZ */
+
+#if (SKIRT_TRACE_SZ & (SKIRT_TRACE_SZ - 1)) || SKIRT_TRACE_SZ > 128
+#error "SKIRT_TRACE_SZ must be a power of two and at most 128!"
+#endif
+
+typedef struct sk_trace_rec {
+	unsigned char event;
+	unsigned char arg;
+	unsigned char stamp_lo;
+	unsigned char stamp_hi;
+} sk_trace_rec;
+
+#define SK_TRACE(event, arg) sk_trace_record((event), (unsigned char)(arg))
+
+#endif /* SKIRT_KERNEL */
+
+/**
+ * @brief Append a record to the trace buffer.
+ * @param event Event type (see sk_trace_event, SK_TRACE_USER and above for applications).
+ * @param arg Event argument.
+ * @note Safe to call from an ISR.
+ */
+extern void sk_trace_record(unsigned char event, unsigned char arg);
+
+/**
+ * @brief Send recorded events on the serial port and empty the buffer.
+ * @return Number of records sent.
+ * @note Meant to be called periodically by a low priority task (streaming mode).
+ */
+extern unsigned char sk_trace_flush(void);
+
+#else
+#define SK_TRACE(event, arg) \
+	do {                 \
+	} while (0)
+#endif /* SKIRT_TRACE */
+
+#endif /* SKIRT_TRACE_H */
@@ -0,0 +1,120 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief Interrupt-driven TWI (I2C) master driver.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A transaction is a list of segments sent to one device, each segment starts
+ * with a (repeated) START and the device address, the last one ends with a
+ * STOP. sk_twi_transfer() queues it and sleeps, the TWI interrupt runs the
+ * whole bus state machine and wakes the task once it is over. Transactions
+ * from several tasks are run one after the other in submission order.
+ */
+
+#ifndef SKIRT_TWI_H
+#define SKIRT_TWI_H
+
+#include <sk/types.h>
+#include <sk/task.h>
+
+/* Segment flags. */
+#define SK_TWI_WRITE 0x00
+#define SK_TWI_READ 0x01
+
+typedef enum sk_twi_status {
+	SK_TWI_OK = 0,
+	SK_TWI_PENDING, /* Queued or on the bus */
+	SK_TWI_NACK_ADDR, /* Nobody answered to the address */
+	SK_TWI_NACK_DATA, /* The device refused a byte before the end */
+	SK_TWI_ARB_LOST, /* Another master took the bus */
+	SK_TWI_BUS_ERROR, /* Illegal START or STOP seen on the bus */
+} sk_twi_status;
+
+typedef struct sk_twi_seg {
+	unsigned char *buf;
+	/* Bytes to send or receive, at least 1 for a read. */
+	unsigned char len;
+	/* SK_TWI_WRITE or SK_TWI_READ. */
+	unsigned char flags;
+} sk_twi_seg;
+
+/* Owned by the driver from sk_twi_transfer() until it returns. */
+typedef struct sk_twi_xfer {
+	const sk_twi_seg *segs;
+	unsigned char nsegs;
+	/* 7-bit device address. */
+	unsigned char addr;
+	/* sk_twi_status, set by the driver. */
+	volatile unsigned char status;
+	sk_task *task;
+	struct sk_twi_xfer *next;
+} sk_twi_xfer;
+
+#ifdef SKIRT_TWI
+
+/* SCL frequency used by sk_twi_init(). */
+#ifndef SKIRT_TWI_FREQ
+#define SKIRT_TWI_FREQ 100000UL
+#endif /* SKIRT_TWI_FREQ */
+
+/**
+ * @brief Enable the TWI master at SKIRT_TWI_FREQ.
+ * @note Pull-ups on SDA and SCL are up to the board.
+ */
+extern void sk_twi_init(void);
+
+/**
+ * @brief Run a transaction, sleeps until it is over.
+ * @param xfer Transaction, segs, nsegs and addr must be set.
+ * @return SK_TWI_OK or the error that ended the transaction.
+ */
+extern sk_twi_status sk_twi_transfer(sk_twi_xfer *xfer);
+
+/**
+ * @brief Write then read back (ex: a register address then its value).
+ * @param addr 7-bit device address.
+ * @param wbuf Bytes to write.
+ * @param wlen Number of bytes to write (the write segment is skipped if 0).
+ * @param rbuf Filled with the bytes read.
+ * @param rlen Number of bytes to read (the read segment is skipped if 0).
+ * @return SK_TWI_OK or the error that ended the transaction.
+ */
+extern sk_twi_status sk_twi_write_read(unsigned char addr, const void *wbuf,
+				       unsigned char wlen, void *rbuf,
+				       unsigned char rlen);
+
+#endif /* SKIRT_TWI */
+
+#endif /* SKIRT_TWI_H */
@@ -0,0 +1,138 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Common helpers for SKIRT benchmarks.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Benchmarks reprogram the preemption timer (TIMER1) to count CPU cycles and
+ * report one line per measurement on the serial port:
+ *
+ *     BENCH <name> <param> <iterations> <total cycles> <cycles per iteration>
+ *
+ * They end with "BENCH END" and put the MCU to sleep with interrupts disabled,
+ * which makes simavr exit. Use tools/skirt_bench.py to run and compare them.
+ */
+
+#ifndef SKIRT_BENCH_H
+#define SKIRT_BENCH_H
+
+#include <sk/task.h>
+#include <sk/serial.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+
+/* Default cycles between two ticks, long enough to keep their noise low. */
+#define BENCH_PERIOD 65536UL
+
+static unsigned long bench_period = BENCH_PERIOD;
+
+/**
+ * @brief Make TIMER1 count cycles (no prescaler), a tick happens every period cycles.
+ */
+static inline void bench_clock_init(unsigned long period)
+{
+	sk_arch_disable_int();
+	bench_period = period;
+	TCCR1B = (1 << WGM12) | (1 << CS10);
+	OCR1A = (unsigned short)(period - 1);
+	TCNT1 = 0;
+	sk_arch_enable_int();
+}
+
+/**
+ * @brief Cycles since an arbitrary point, ticks included.
+ * @note Must be called with interrupts disabled.
+ */
+static inline unsigned long bench_now_locked(void)
+{
+	unsigned short count = TCNT1;
+	unsigned long ticks = sk_kernel_ticks();
+
+	/* Compare match not serviced yet. */
+	if ((TIFR1 & (1 << OCF1A)) && count < bench_period / 2) {
+		ticks++;
+	}
+	return ticks * bench_period + count;
+}
+
+static inline unsigned long bench_now(void)
+{
+	sk_arch_disable_int();
+	unsigned long now = bench_now_locked();
+	sk_arch_enable_int();
+	return now;
+}
+
+/**
+ * @brief Print one report line.
+ */
+static inline void bench_report(const char *name, unsigned long param,
+				unsigned long iters, unsigned long cycles)
+{
+	sk_serial_print("BENCH ");
+	sk_serial_print(name);
+	sk_serial_putc(' ');
+	sk_serial_print_uint(param);
+	sk_serial_putc(' ');
+	sk_serial_print_uint(iters);
+	sk_serial_putc(' ');
+	sk_serial_print_uint(cycles);
+	sk_serial_putc(' ');
+	sk_serial_print_uint(iters ? cycles / iters : 0);
+	sk_serial_print("\n\r");
+}
+
+/**
+ * @brief End the benchmark, simavr exits on sleep with interrupts disabled.
+ */
+static inline SK_NORETURN void bench_done(void)
+{
+	sk_serial_print("BENCH END");
+	sk_arch_disable_int();
+	/* Let the last bytes leave the UART. */
+	UCSR0A |= (1 << TXC0);
+	sk_serial_print("\n\r");
+	while (!(UCSR0A & (1 << TXC0)))
+		;
+
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	sleep_enable();
+	for (;;) {
+		sleep_cpu();
+	}
+}
+
+#endif /* SKIRT_BENCH_H */
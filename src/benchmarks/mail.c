@@ -0,0 +1,83 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Mail throughput benchmark.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * The task fills its own mailbox up to param mails then picks them all up,
+ * one iteration is one sk_mail_send_to() and one sk_mail_pickup().
+ */
+
+#include "bench.h"
+#include <sk/ipc.h>
+
+#define ROUNDS 200UL
+
+/* Same default as the kernel mail pool. */
+#ifndef SKIRT_MAIL_MAX
+#define SKIRT_MAIL_MAX SKIRT_TASK_MAX
+#endif /* SKIRT_MAIL_MAX */
+
+static sk_stack_t bench_stack[128];
+
+static sk_task *bench_task = NULL;
+
+static void bench(void)
+{
+	bench_clock_init(BENCH_PERIOD);
+
+	for (unsigned short depth = 1; depth <= SKIRT_MAIL_MAX; depth *= 2) {
+		unsigned long start = bench_now();
+		for (unsigned long r = 0; r < ROUNDS; ++r) {
+			for (unsigned short i = 0; i < depth; ++i) {
+				sk_mail_send_to(bench_task, &bench_task);
+			}
+			for (unsigned short i = 0; i < depth; ++i) {
+				sk_mail_pickup();
+			}
+		}
+		bench_report("mail", depth, ROUNDS * depth, bench_now() - start);
+	}
+
+	bench_done();
+}
+
+int main(void)
+{
+	bench_task = sk_task_create_static(bench, 1, bench_stack,
+					   sizeof bench_stack);
+	sk_kernel_start();
+}
@@ -0,0 +1,129 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Client/server round trip benchmark.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * - msg_rpc: sk_msg_send() to a server calling sk_msg_receive() and
+ *   sk_msg_reply(), one iteration is a request and its reply.
+ * - mail_rpc: the same round trip built from mails, a semaphore wakes each
+ *   side (two mails, two releases, two acquires).
+ *
+ * Blocked semaphore acquirers yield in a loop, mail_rpc is only reported with
+ * round-robin scheduling (see sem.c).
+ */
+
+#include "bench.h"
+#include <sk/ipc.h>
+
+#define ITERS 1000UL
+
+static sk_stack_t bench_stack[128];
+static sk_stack_t server_stack[SKIRT_TASK_STACK_SZ];
+static sk_stack_t mail_server_stack[SKIRT_TASK_STACK_SZ];
+
+static sk_task *bench_task = NULL;
+static sk_task *server_task = NULL;
+static sk_task *mail_server_task = NULL;
+
+#if defined(SKIRT_MAIL) && defined(SKIRT_SEM)
+static sk_sem *request_sem = NULL;
+static sk_sem *reply_sem = NULL;
+#endif /* SKIRT_MAIL && SKIRT_SEM */
+
+static void server(void)
+{
+	for (;;) {
+		sk_msg *msg = sk_msg_receive();
+		const unsigned char *request = msg->data;
+		*(unsigned char *)msg->reply = *request;
+		sk_msg_reply(msg, 1);
+	}
+}
+
+static void mail_server(void)
+{
+#if defined(SKIRT_MAIL) && defined(SKIRT_SEM)
+	for (;;) {
+		sk_sem_acquire(request_sem);
+		sk_mail_send_to(bench_task, sk_mail_pickup());
+		sk_sem_release(reply_sem);
+	}
+#endif /* SKIRT_MAIL && SKIRT_SEM */
+}
+
+static void bench(void)
+{
+	unsigned char request = 0;
+	unsigned char reply = 0;
+
+	bench_clock_init(BENCH_PERIOD);
+
+	unsigned long start = bench_now();
+	for (unsigned long i = 0; i < ITERS; ++i) {
+		sk_msg_send(server_task, &request, 1, &reply, 1);
+	}
+	bench_report("msg_rpc", 2, ITERS, bench_now() - start);
+
+#if defined(SKIRT_MAIL) && defined(SKIRT_SEM) && !defined(SKIRT_HARD_PRIO)
+	start = bench_now();
+	for (unsigned long i = 0; i < ITERS; ++i) {
+		sk_mail_send_to(mail_server_task, &request);
+		sk_sem_release(request_sem);
+		sk_sem_acquire(reply_sem);
+		sk_mail_pickup();
+	}
+	bench_report("mail_rpc", 2, ITERS, bench_now() - start);
+#endif /* SKIRT_MAIL && SKIRT_SEM && !SKIRT_HARD_PRIO */
+
+	bench_done();
+}
+
+int main(void)
+{
+#if defined(SKIRT_MAIL) && defined(SKIRT_SEM)
+	request_sem = sk_sem_create(0);
+	reply_sem = sk_sem_create(0);
+#endif /* SKIRT_MAIL && SKIRT_SEM */
+	bench_task = sk_task_create_static(bench, 1, bench_stack,
+					   sizeof bench_stack);
+	server_task = sk_task_create_static(server, 1, server_stack,
+					    sizeof server_stack);
+	mail_server_task = sk_task_create_static(mail_server, 1,
+						 mail_server_stack,
+						 sizeof mail_server_stack);
+	sk_kernel_start();
+}
@@ -0,0 +1,98 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Semaphore ping-pong benchmark.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Two tasks hand two semaphores back and forth, one iteration is a round trip
+ * (two releases, two acquires and two context switches).
+ *
+ * Blocked tasks stay READY and yield in a loop, with SKIRT_HARD_PRIO the
+ * highest priority task would never let the other one run: the benchmark is
+ * only reported with round-robin scheduling.
+ */
+
+#include "bench.h"
+#include <sk/ipc.h>
+
+#define ITERS 1000UL
+
+static sk_stack_t bench_stack[128];
+static sk_stack_t partner_stack[SKIRT_TASK_STACK_SZ];
+
+static sk_sem *ping = NULL;
+static sk_sem *pong = NULL;
+
+static void partner(void)
+{
+	for (;;) {
+		sk_sem_acquire(ping);
+		sk_sem_release(pong);
+	}
+}
+
+static void bench(void)
+{
+	bench_clock_init(BENCH_PERIOD);
+
+#ifndef SKIRT_HARD_PRIO
+	unsigned long start = bench_now();
+	for (unsigned long i = 0; i < ITERS; ++i) {
+		sk_sem_release(ping);
+		sk_sem_acquire(pong);
+	}
+	bench_report("sem_pingpong", 2, ITERS, bench_now() - start);
+
+	/* No contention, acquire never yields. */
+	start = bench_now();
+	for (unsigned long i = 0; i < ITERS; ++i) {
+		sk_sem_release(pong);
+		sk_sem_acquire(pong);
+	}
+	bench_report("sem_uncontended", 1, ITERS, bench_now() - start);
+#endif /* SKIRT_HARD_PRIO */
+
+	bench_done();
+}
+
+int main(void)
+{
+	ping = sk_sem_create(0);
+	pong = sk_sem_create(0);
+	sk_task_create_static(bench, 1, bench_stack, sizeof bench_stack);
+	sk_task_create_static(partner, 1, partner_stack, sizeof partner_stack);
+	sk_kernel_start();
+}
@@ -0,0 +1,89 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Task creation and deletion benchmark.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Tasks are created and killed from a running task with interrupts disabled,
+ * they never get to run. Creation includes stack painting when
+ * SKIRT_STACK_CHECK is set, param is the stack size.
+ */
+
+#include "bench.h"
+
+#define ITERS 200UL
+
+static sk_stack_t bench_stack[128];
+static sk_stack_t victim_stack[SKIRT_TASK_STACK_SZ];
+
+static void victim(void)
+{
+	for (;;) {
+		sk_task_await();
+	}
+}
+
+static void bench(void)
+{
+	bench_clock_init(BENCH_PERIOD);
+
+	unsigned long create = 0;
+	unsigned long kill = 0;
+	for (unsigned long i = 0; i < ITERS; ++i) {
+		sk_arch_disable_int();
+		unsigned long start = bench_now_locked();
+		sk_task *task = sk_task_create_static(victim, 1, victim_stack,
+						      sizeof victim_stack);
+		unsigned long end = bench_now_locked();
+		create += end - start;
+
+		/* sk_task_kill() enables interrupts on its way out. */
+		start = bench_now_locked();
+		sk_task_kill(task);
+		kill += bench_now() - start;
+	}
+
+	bench_report("task_create", sizeof victim_stack, ITERS, create);
+	bench_report("task_kill", sizeof victim_stack, ITERS, kill);
+
+	bench_done();
+}
+
+int main(void)
+{
+	sk_task_create_static(bench, 1, bench_stack, sizeof bench_stack);
+	sk_kernel_start();
+}
@@ -0,0 +1,124 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Preemption tick cost as a function of the number of tasks.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * The same busy loop is timed with interrupts disabled, then with a tick every
+ * TICK_PERIOD cycles: the difference divided by the number of ticks is the
+ * cost of one tick (ISR, counters update and scheduling). Other tasks are
+ * WAITING, killed one by one between measurements, param is the total number
+ * of tasks including idle and other kernel tasks.
+ */
+
+#include "bench.h"
+
+#define TICK_PERIOD 1024UL
+#define WORK_LOOPS 4000U
+/* Every slot left by kernel tasks except the bench task. */
+#define WAITERS (SKIRT_TASK_MAX - SK_KERNEL_TASKS - 1)
+#if WAITERS <= 0
+#error "SKIRT_TASK_MAX leaves no room for waiters, raise it!"
+#endif
+
+static sk_stack_t bench_stack[128];
+static sk_stack_t waiter_stacks[WAITERS][SKIRT_TASK_STACK_SZ];
+
+static sk_task *waiters[WAITERS];
+static volatile unsigned char waiters_started = 0;
+
+static void waiter(void)
+{
+	sk_arch_disable_int();
+	waiters_started++;
+	sk_arch_enable_int();
+	for (;;) {
+		sk_task_await();
+	}
+}
+
+/* Fixed amount of work, well under BENCH_PERIOD cycles. */
+static void work(void)
+{
+	for (volatile unsigned short i = 0; i < WORK_LOOPS; ++i)
+		;
+}
+
+static void bench(void)
+{
+	while (waiters_started < WAITERS) {
+		sk_arch_disable_int();
+		sk_arch_yield();
+	}
+
+	for (unsigned char alive = WAITERS;; --alive) {
+		bench_clock_init(BENCH_PERIOD);
+		sk_arch_disable_int();
+		unsigned long start = bench_now_locked();
+		work();
+		unsigned long quiet = bench_now_locked() - start;
+		sk_arch_enable_int();
+
+		bench_clock_init(TICK_PERIOD);
+		sk_size_t ticks = sk_kernel_ticks();
+		start = bench_now();
+		work();
+		unsigned long busy = bench_now() - start;
+		ticks = sk_kernel_ticks() - ticks;
+
+		bench_report("tick", alive + SK_KERNEL_TASKS + 1, ticks,
+			     busy - quiet);
+
+		if (!alive) {
+			break;
+		}
+		sk_task_kill(waiters[alive - 1]);
+	}
+
+	bench_clock_init(BENCH_PERIOD);
+	bench_done();
+}
+
+int main(void)
+{
+	/* With SKIRT_HARD_PRIO, waiters run first and wait. */
+	sk_task_create_static(bench, 1, bench_stack, sizeof bench_stack);
+	for (unsigned char i = 0; i < WAITERS; ++i) {
+		waiters[i] = sk_task_create_static(waiter, 2, waiter_stacks[i],
+						   sizeof waiter_stacks[i]);
+	}
+	sk_kernel_start();
+}
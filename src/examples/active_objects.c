@@ -0,0 +1,116 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Active objects example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A "sensor" task publishes a reading, two active objects subscribed to it
+ * receive the same event without any copy. Both run on the single dispatcher
+ * task instead of having their own stacks.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Contains functions starting with sk_ao and sk_event */
+#include <sk/ao.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+#define SIG_READING 1
+#define SIG_RESET 2
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+
+sk_task *sensor = NULL;
+sk_ao *logger_ao = NULL;
+sk_ao *alarm_ao = NULL;
+
+void logger_dispatch(sk_ao *ao, const sk_event *e)
+{
+	(void)ao;
+	switch (e->sig) {
+	case SIG_READING:
+		sk_serial_print("Reading: ");
+		sk_serial_print_uint(e->data[0]);
+		sk_serial_print("\n\r");
+		break;
+	case SIG_RESET:
+		sk_serial_print("Reset requested\n\r");
+		break;
+	}
+}
+
+void alarm_dispatch(sk_ao *ao, const sk_event *e)
+{
+	(void)ao;
+	if (e->sig == SIG_READING && e->data[0] > 200) {
+		sk_serial_print("Alarm!\n\r");
+		sk_event *reset = sk_event_new(SIG_RESET);
+		if (reset) {
+			sk_ao_post(logger_ao, reset);
+		}
+	}
+}
+
+void func_sensor(void)
+{
+	unsigned char value = 0;
+	while (1) {
+		sk_event *e = sk_event_new(SIG_READING);
+		if (e) {
+			e->data[0] = value;
+			sk_ao_publish(e);
+		}
+		value += 25;
+		sk_task_sleep(200);
+	}
+}
+
+int main(void)
+{
+	sensor = sk_task_create_static(func_sensor, 1, stack1, sizeof stack1);
+
+	/* Active objects are dispatched by order of priority. */
+	alarm_ao = sk_ao_create(alarm_dispatch, 2, NULL);
+	logger_ao = sk_ao_create(logger_dispatch, 1, NULL);
+	sk_ao_subscribe(alarm_ao, SIG_READING);
+	sk_ao_subscribe(logger_ao, SIG_READING);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,123 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief ADC driver example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * T1 samples A0 and A1 at 2kHz (1kHz each) and prints the mean, minimum and
+ * maximum of each channel about once per second, with the blocks dropped.
+ * T2 shows the CPU left while sampling.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Contains functions starting with sk_adc */
+#include <sk/adc.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+#define CHANNELS 2
+#define RATE 2000
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+
+sk_task *t1 = NULL;
+sk_task *t2 = NULL;
+
+volatile unsigned long idle_loops = 0;
+
+void func_t1(void)
+{
+	static const unsigned char channels[CHANNELS] = { 0, 1 };
+	unsigned char blocks = 0;
+
+	sk_adc_start(channels, CHANNELS, RATE);
+	for (;;) {
+		const unsigned short *samples = sk_adc_wait();
+
+		/* Printing every block would take longer than filling one. */
+		if (++blocks < RATE / SKIRT_ADC_BLOCK) {
+			continue;
+		}
+		blocks = 0;
+
+		for (unsigned char c = 0; c < CHANNELS; ++c) {
+			unsigned long sum = 0;
+			unsigned short min = 0xffff;
+			unsigned short max = 0;
+
+			for (unsigned char i = c; i < SKIRT_ADC_BLOCK;
+			     i += CHANNELS) {
+				sum += samples[i];
+				min = samples[i] < min ? samples[i] : min;
+				max = samples[i] > max ? samples[i] : max;
+			}
+			sk_serial_print("T1: A");
+			sk_serial_print_uint(channels[c]);
+			sk_serial_print(" mean ");
+			sk_serial_print_uint(sum /
+					     (SKIRT_ADC_BLOCK / CHANNELS));
+			sk_serial_print(" min ");
+			sk_serial_print_uint(min);
+			sk_serial_print(" max ");
+			sk_serial_print_uint(max);
+			sk_serial_print("\n\r");
+		}
+		sk_serial_print("T1: overruns ");
+		sk_serial_print_uint(sk_adc_overruns());
+		sk_serial_print(", idle loops ");
+		sk_serial_print_uint(idle_loops);
+		sk_serial_print("\n\r");
+	}
+}
+
+void func_t2(void)
+{
+	for (;;) {
+		idle_loops++;
+	}
+}
+
+int main(void)
+{
+	t1 = sk_task_create_static(func_t1, 2, stack1, sizeof stack1);
+	t2 = sk_task_create_static(func_t2, 1, stack2, sizeof stack2);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
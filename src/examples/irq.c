@@ -0,0 +1,102 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Hardware interrupts example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * This example shows how to wake a task from an interrupt.
+ * Pulling INT0 (PD2, pin 2 on Arduino Uno, PD0, pin 21 on Arduino Mega) low
+ * wakes T1 which prints a message. T2 is attached to INT1 (PD3, pin 3 on
+ * Arduino Uno, PD1, pin 20 on Arduino Mega) and only prints every 4 falling
+ * edges on INT1.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Contains SKIRT_IRQ and functions starting with sk_irq */
+#include <sk/irq.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+
+sk_task *t1 = NULL;
+sk_task *t2 = NULL;
+
+/* Wraps INT0_vect, the kernel handles context saving and rescheduling. */
+SKIRT_IRQ(INT0_vect, int0_irq)
+SKIRT_IRQ(INT1_vect, int1_irq)
+
+void func_t1(void)
+{
+	while (1) {
+		sk_irq_wait(&int0_irq);
+		sk_serial_print("INT0!\n\r");
+	}
+}
+
+void func_t2(void)
+{
+	while (1) {
+		sk_irq_wait(&int1_irq);
+		sk_serial_print("INT1 x4!\n\r");
+	}
+}
+
+int main(void)
+{
+	t1 = sk_task_create_static(func_t1, 2, stack1, sizeof stack1);
+	t2 = sk_task_create_static(func_t2, 1, stack2, sizeof stack2);
+
+	/* Wake T1 on every edge and T2 every 4 edges. */
+	sk_irq_attach(&int0_irq, t1, 1);
+	sk_irq_attach(&int1_irq, t2, 4);
+
+	/* Falling edge on INT0 and INT1, with pull-ups enabled. */
+#ifdef __AVR_ATmega2560__
+	PORTD |= (1 << PORTD0) | (1 << PORTD1);
+#else
+	PORTD |= (1 << PORTD2) | (1 << PORTD3);
+#endif /* __AVR_ATmega2560__ */
+	EICRA = (1 << ISC01) | (1 << ISC11);
+	EIMSK = (1 << INT0) | (1 << INT1);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,112 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief Framed binary link example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A task streams fake sensor samples on SK_LINK_APP and task statistics now
+ * and then, another one sends back every frame it receives on
+ * SK_LINK_APP + 1. Read it with:
+ *     tools/skirt_link.py /dev/ttyACM0 --elf link.elf
+ * On the host port, frames can be piped in:
+ *     tools/skirt_link.py --send 16 68656c6c6f | ./link.elf | \
+ *         tools/skirt_link.py
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Contains functions starting with sk_link */
+#include <sk/link.h>
+/* SK_LOG*() macros, records go through the link as well. */
+#include <sk/log.h>
+
+#define SAMPLES 8
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+
+sk_task *t1 = NULL;
+sk_task *t2 = NULL;
+
+void func_t1(void)
+{
+	unsigned char frame[2 * SAMPLES];
+	unsigned short value = 0;
+	unsigned dropped = 0;
+
+	for (unsigned count = 1;; ++count) {
+		/* 16-bit little-endian samples, a sawtooth. */
+		for (unsigned char i = 0; i < SAMPLES; ++i) {
+			value += 37;
+			frame[2 * i] = (unsigned char)value;
+			frame[2 * i + 1] = (unsigned char)(value >> 8);
+		}
+		if (!sk_link_send(SK_LINK_APP, frame, sizeof frame)) {
+			dropped++;
+		}
+
+		if (!(count % 64)) {
+			SK_LOG2("%u frames, %u dropped", count, dropped);
+			sk_link_send_stats();
+		}
+		sk_task_sleep(2);
+	}
+}
+
+void func_t2(void)
+{
+	unsigned char buf[32];
+	unsigned char channel;
+
+	for (;;) {
+		/* Sleeps until the RX interrupt has a whole frame. */
+		unsigned char len = sk_link_recv(&channel, buf, sizeof buf);
+		SK_LOG2("Received %u bytes on channel %u", len, channel);
+		sk_link_send(SK_LINK_APP + 1, buf,
+			     len < sizeof buf ? len : sizeof buf);
+	}
+}
+
+int main(void)
+{
+	/* If SKIRT_HARD_PRIO is not set, priority does not matter. */
+	t1 = sk_task_create_static(func_t1, 2, stack1, sizeof stack1);
+	t2 = sk_task_create_static(func_t2, 3, stack2, sizeof stack2);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,89 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Deferred logging example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Two tasks log counters with SK_LOG*(), formats stay in flash and only IDs
+ * and arguments go through the serial port. Read it with:
+ *     tools/skirt_log.py logging.elf < /dev/ttyACM0
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* SK_LOG*() macros. */
+#include <sk/log.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+
+sk_task *t1 = NULL;
+sk_task *t2 = NULL;
+
+void func_t1(void)
+{
+	/* Plain text from flash can be mixed with log records. */
+	sk_serial_print_P(SK_PSTR("Logging example\n\r"));
+
+	for (unsigned count = 0;; ++count) {
+		SK_LOG1("T1 count %u", count);
+		sk_task_sleep(2);
+	}
+}
+
+void func_t2(void)
+{
+	long sum = 0;
+	for (int value = -8;; ++value) {
+		sum += value;
+		SK_LOG3("T2 value %d sum %ld (0x%lx)", value, sum, sum);
+		sk_task_sleep(3);
+	}
+}
+
+int main(void)
+{
+	/* If SKIRT_HARD_PRIO is not set, priority does not matter. */
+	t1 = sk_task_create_static(func_t1, 3, stack1, sizeof stack1);
+	t2 = sk_task_create_static(func_t2, 2, stack2, sizeof stack2);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,119 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Send/Receive/Reply messages example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Two clients ask a lower priority server to add numbers. Requests and replies
+ * stay on the client stacks, the server reads and writes them in place while
+ * the client is blocked, running at the client priority meanwhile.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Messages are IPCs. */
+#include <sk/ipc.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+struct add_request {
+	unsigned short a;
+	unsigned short b;
+};
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack3[SKIRT_TASK_STACK_SZ];
+
+sk_task *server = NULL;
+sk_task *client1 = NULL;
+sk_task *client2 = NULL;
+
+void func_server(void)
+{
+	for (;;) {
+		sk_msg *msg = sk_msg_receive();
+		const struct add_request *req = msg->data;
+		unsigned long *sum = msg->reply;
+
+		*sum = (unsigned long)req->a + req->b;
+		sk_msg_reply(msg, sizeof *sum);
+	}
+}
+
+static void client(const char *name, unsigned short step)
+{
+	struct add_request req = { 0, 0 };
+	unsigned long sum = 0;
+
+	for (;;) {
+		req.a += step;
+		req.b += 2 * step;
+		sk_msg_send(server, &req, sizeof req, &sum, sizeof sum);
+
+		sk_serial_print(name);
+		sk_serial_print_uint(req.a);
+		sk_serial_print(" + ");
+		sk_serial_print_uint(req.b);
+		sk_serial_print(" = ");
+		sk_serial_print_uint(sum);
+		sk_serial_print("\n\r");
+		sk_task_sleep(100 * step);
+	}
+}
+
+void func_client1(void)
+{
+	client("Client 1: ", 1);
+}
+
+void func_client2(void)
+{
+	client("Client 2: ", 3);
+}
+
+int main(void)
+{
+	/* With SKIRT_HARD_PRIO, the server runs at its client priority. */
+	server = sk_task_create_static(func_server, 1, stack1, sizeof stack1);
+	client1 = sk_task_create_static(func_client1, 2, stack2, sizeof stack2);
+	client2 = sk_task_create_static(func_client2, 3, stack3, sizeof stack3);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,115 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Protothreads example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * This example runs three stackless tasks (protothreads) next to a normal task.
+ * They all share the stack of a single kernel task, local variables are not
+ * kept when blocking so static ones are used instead.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Contains functions and macros starting with sk_pt/SK_PT */
+#include <sk/pt.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+
+sk_task *t1 = NULL;
+sk_pt *printer = NULL;
+sk_sem *s1 = NULL;
+
+/* Sends a mail to the printer every 100 ticks. */
+char pt_producer(sk_pt *pt)
+{
+	static unsigned char i;
+
+	SK_PT_BEGIN(pt);
+	for (i = 0; i < 10; ++i) {
+		sk_pt_mail_send(printer, "Tick from producer\n\r");
+		SK_PT_SLEEP(pt, 100);
+	}
+	SK_PT_END(pt);
+}
+
+/* Prints every mail it receives. */
+char pt_printer(sk_pt *pt)
+{
+	SK_PT_BEGIN(pt);
+	for (;;) {
+		SK_PT_WAIT_MAIL(pt);
+		sk_serial_print(sk_pt_mail_pickup(pt));
+	}
+	SK_PT_END(pt);
+}
+
+/* Waits for T1 to release the semaphore. */
+char pt_waiter(sk_pt *pt)
+{
+	SK_PT_BEGIN(pt);
+	for (;;) {
+		SK_PT_WAIT_SEM(pt, s1);
+		sk_serial_print("Semaphore released by T1\n\r");
+	}
+	SK_PT_END(pt);
+}
+
+void func_t1(void)
+{
+	while (1) {
+		sk_task_sleep(500);
+		sk_sem_release(s1);
+	}
+}
+
+int main(void)
+{
+	t1 = sk_task_create_static(func_t1, 1, stack1, sizeof stack1);
+	s1 = sk_sem_create(0);
+
+	/* Protothreads are run by order of priority. */
+	printer = sk_pt_create(pt_printer, 3, NULL);
+	sk_pt_create(pt_producer, 2, NULL);
+	sk_pt_create(pt_waiter, 1, NULL);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
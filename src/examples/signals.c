@@ -0,0 +1,112 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Signals example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A worker sums numbers forever, a controller asks it for a progress report
+ * now and then and finally cancels it. Handlers run on the worker stack, in
+ * between two instructions of its loop.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Signals are IPCs. */
+#include <sk/ipc.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+#define SIG_REPORT 0
+#define SIG_CANCEL 1
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+
+sk_task *worker = NULL;
+
+static volatile unsigned long sum = 0;
+
+static void on_report(int sig)
+{
+	(void)sig;
+	sk_serial_print("Worker: sum is ");
+	sk_serial_print_uint(sum);
+	sk_serial_print("\n\r");
+}
+
+static void on_cancel(int sig)
+{
+	(void)sig;
+	sk_serial_print("Worker: cancelled\n\r");
+	sk_task_exit();
+}
+
+void func_worker(void)
+{
+	for (unsigned long i = 0;; ++i) {
+		/* Keep the report consistent while sum is updated. */
+		unsigned char blocked = sk_sig_block(1 << SIG_REPORT);
+		sum += i & 0xff;
+		sk_sig_block(blocked);
+	}
+}
+
+void func_controller(void)
+{
+	for (int i = 0; i < 5; ++i) {
+		sk_task_sleep(100);
+		sk_serial_print("Controller: report please\n\r");
+		sk_sig_send(worker, SIG_REPORT);
+	}
+	sk_task_sleep(100);
+	sk_serial_print("Controller: cancel\n\r");
+	sk_sig_send(worker, SIG_CANCEL);
+	sk_task_exit();
+}
+
+int main(void)
+{
+	sk_sig_register(SIG_REPORT, on_report);
+	sk_sig_register(SIG_CANCEL, on_cancel);
+
+	worker = sk_task_create_static(func_worker, 1, stack1, sizeof stack1);
+	sk_task_create_static(func_controller, 2, stack2, sizeof stack2);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
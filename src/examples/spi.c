@@ -0,0 +1,154 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief SPI driver example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * T1 reads the JEDEC ID of a SPI NOR flash (CS on pin 10 of an Arduino Uno,
+ * pin 53 of an Arduino Mega) then streams its first KiB in 64-byte blocks:
+ * the next block is submitted before the current one is checksummed, so the
+ * SPI interrupt shifts bytes while the task computes. T2 shows the CPU left.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Contains functions starting with sk_spi */
+#include <sk/spi.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+#ifdef __AVR_ATmega2560__
+#define FLASH_CS_BIT 0
+#else
+#define FLASH_CS_BIT 2
+#endif /* __AVR_ATmega2560__ */
+
+#define FLASH_READ_ID 0x9f
+#define FLASH_READ 0x03
+
+#define BLOCK_SZ 64
+#define BLOCKS 16
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+
+sk_task *t1 = NULL;
+sk_task *t2 = NULL;
+
+sk_spi_dev flash;
+
+unsigned char blocks[2][BLOCK_SZ];
+volatile unsigned long idle_loops = 0;
+
+void func_t1(void)
+{
+	unsigned char id_cmd[4] = { FLASH_READ_ID };
+	unsigned char id[4];
+	sk_spi_xfer xfer = { .dev = &flash, .tx = id_cmd, .rx = id, .len = 4 };
+
+	sk_spi_transfer(&xfer);
+	sk_serial_print("T1: JEDEC ID ");
+	for (unsigned char i = 1; i < sizeof id; ++i) {
+		sk_serial_print_uint(id[i]);
+		sk_serial_putc(' ');
+	}
+	sk_serial_print("\n\r");
+
+	for (;;) {
+		/* One read command, CS stays low until the last block. */
+		unsigned char read_cmd[4] = { FLASH_READ, 0, 0, 0 };
+		sk_spi_xfer cmd = { .dev = &flash,
+				    .tx = read_cmd,
+				    .len = sizeof read_cmd,
+				    .flags = SK_SPI_KEEP_CS };
+		sk_spi_xfer xfers[2] = { { .dev = &flash,
+					   .rx = blocks[0],
+					   .len = BLOCK_SZ,
+					   .flags = SK_SPI_KEEP_CS } };
+		unsigned long sum = 0;
+
+		sk_spi_submit(&cmd);
+		sk_spi_submit(&xfers[0]);
+		for (unsigned char i = 0; i < BLOCKS; ++i) {
+			unsigned char cur = i & 1;
+			unsigned char next = cur ^ 1;
+
+			if (i + 1 < BLOCKS) {
+				xfers[next] = (sk_spi_xfer){
+					.dev = &flash,
+					.rx = blocks[next],
+					.len = BLOCK_SZ,
+					.flags = i + 2 < BLOCKS ? SK_SPI_KEEP_CS :
+								  0,
+				};
+				sk_spi_submit(&xfers[next]);
+			}
+
+			sk_spi_wait(&xfers[cur]);
+			for (unsigned char j = 0; j < BLOCK_SZ; ++j) {
+				sum += blocks[cur][j];
+			}
+		}
+
+		sk_serial_print("T1: sum ");
+		sk_serial_print_uint(sum);
+		sk_serial_print(", idle loops ");
+		sk_serial_print_uint(idle_loops);
+		sk_serial_print("\n\r");
+		sk_task_sleep(500);
+	}
+}
+
+void func_t2(void)
+{
+	for (;;) {
+		idle_loops++;
+	}
+}
+
+int main(void)
+{
+	t1 = sk_task_create_static(func_t1, 2, stack1, sizeof stack1);
+	t2 = sk_task_create_static(func_t2, 1, stack2, sizeof stack2);
+
+	sk_spi_init();
+	/* Mode 0, 4MHz at 16MHz. */
+	sk_spi_dev_init(&flash, &PORTB, FLASH_CS_BIT, 0, 4);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,101 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief CPU usage statistics example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A busy task never yields while a reporter wakes up once per statistics
+ * window: the busy task should be charged about 100% of the CPU, the
+ * reporter and the idle task about 0%.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+
+sk_task *busy = NULL;
+sk_task *reporter = NULL;
+
+static volatile unsigned long spins = 0;
+
+void func_busy(void)
+{
+	for (;;) {
+		spins++;
+	}
+}
+
+static void report(const char *name, sk_task *task)
+{
+	sk_task_stats stats;
+	sk_task_stats_get(task, &stats);
+
+	sk_serial_print(name);
+	sk_serial_print_uint(stats.cpu_percent);
+	sk_serial_print("% cpu, ");
+	sk_serial_print_uint((unsigned long)(stats.runtime_us / 1000));
+	sk_serial_print(" ms run, ");
+	sk_serial_print_uint(stats.running);
+	sk_serial_print(" ticks running\n\r");
+}
+
+void func_reporter(void)
+{
+	for (;;) {
+		sk_task_sleep(SKIRT_STATS_WINDOW);
+		report("Busy: ", busy);
+		report("Reporter: ", reporter);
+		sk_serial_print("Idle: ");
+		sk_serial_print_uint(sk_kernel_idle_percent());
+		sk_serial_print("%\n\r");
+	}
+}
+
+int main(void)
+{
+	busy = sk_task_create_static(func_busy, 1, stack1, sizeof stack1);
+	reporter = sk_task_create_static(func_reporter, 2, stack2,
+					 sizeof stack2);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,188 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Randomized stress workload with SKIRT (host only)
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Every worker loops on random operations: critical sections protected by
+ * semaphores, mails to random peers, mail pickups and short sleeps. The monitor
+ * task prints the throughput every STRESS_PERIOD ticks and exits after
+ * STRESS_ROUNDS periods, with a non-zero status if a critical section was
+ * entered twice or more mails were picked up than sent.
+ *
+ * Build with SKIRT_ARCH=posix and round-robin scheduling, raise SKIRT_TASK_MAX
+ * for more workers and lower SKIRT_POSIX_TICK_US to run faster:
+ *
+ *     cmake .. -DSKIRT_ARCH=posix -DSKIRT_EXAMPLES=1 -DSKIRT_TASK_MAX=200 \
+ *         -DCMAKE_C_FLAGS="-DSKIRT_POSIX_TICK_US=100 -DSKIRT_POSIX_SKIP_IDLE"
+ */
+
+#include <sk/task.h>
+#include <sk/ipc.h>
+#include <sk/serial.h>
+
+#include <stdlib.h>
+
+#ifndef STRESS_PERIOD
+#define STRESS_PERIOD 100
+#endif /* STRESS_PERIOD */
+
+#ifndef STRESS_ROUNDS
+#define STRESS_ROUNDS 10
+#endif /* STRESS_ROUNDS */
+
+/* Every slot left by kernel tasks except the monitor task. */
+#define STRESS_WORKERS (SKIRT_TASK_MAX - SK_KERNEL_TASKS - 1)
+#if STRESS_WORKERS < 1
+#error "SKIRT_TASK_MAX leaves no room for workers, raise it!"
+#endif
+#define STRESS_LOCKS 4
+
+sk_stack_t monitor_stack[SKIRT_TASK_STACK_SZ];
+sk_stack_t worker_stacks[STRESS_WORKERS][SKIRT_TASK_STACK_SZ];
+
+sk_task *workers[STRESS_WORKERS];
+sk_sem *locks[STRESS_LOCKS];
+
+/* Both halves must always be equal outside of a critical section. */
+volatile unsigned long entered[STRESS_LOCKS];
+volatile unsigned long left[STRESS_LOCKS];
+
+volatile unsigned long ops = 0;
+volatile unsigned long mails_sent = 0;
+volatile unsigned long mails_picked = 0;
+volatile bool failed = false;
+
+/* Tasks may be preempted anywhere, libc rand() is not safe here. */
+static unsigned long stress_rand(unsigned long *state)
+{
+	unsigned long x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+	return x;
+}
+
+static void stress_count(volatile unsigned long *counter)
+{
+	sk_arch_disable_int();
+	(*counter)++;
+	sk_arch_enable_int();
+}
+
+void worker(void)
+{
+	unsigned long rng = sk_task_self() * 2654435761UL + 1;
+
+	for (;;) {
+		unsigned long r = stress_rand(&rng);
+		unsigned char lock = r % STRESS_LOCKS;
+
+		switch ((r >> 8) % 4) {
+		case 0:
+			sk_sem_acquire(locks[lock]);
+			if (entered[lock] != left[lock]) {
+				failed = true;
+			}
+			entered[lock]++;
+			for (volatile unsigned char i = 0; i < (r >> 16) % 64;
+			     ++i) {
+				sk_arch_nop();
+			}
+			left[lock]++;
+			sk_sem_release(locks[lock]);
+			break;
+		case 1:
+			if (sk_mail_send_to(workers[(r >> 16) % STRESS_WORKERS],
+					    locks[lock])) {
+				stress_count(&mails_sent);
+			}
+			break;
+		case 2:
+			while (sk_mail_pickup()) {
+				stress_count(&mails_picked);
+			}
+			break;
+		default:
+			sk_task_sleep(1 + (r >> 16) % 3);
+			break;
+		}
+		stress_count(&ops);
+	}
+}
+
+void monitor(void)
+{
+	for (unsigned round = 1; round <= STRESS_ROUNDS; ++round) {
+		sk_task_sleep(STRESS_PERIOD);
+
+		sk_arch_disable_int();
+		unsigned long done = ops;
+		unsigned long sent = mails_sent;
+		unsigned long picked = mails_picked;
+		if (picked > sent) {
+			failed = true;
+		}
+		sk_arch_enable_int();
+
+		sk_serial_print("ticks ");
+		sk_serial_print_uint(sk_kernel_ticks());
+		sk_serial_print(" ops ");
+		sk_serial_print_uint(done);
+		sk_serial_print(" mails ");
+		sk_serial_print_uint(sent);
+		sk_serial_putc('/');
+		sk_serial_print_uint(picked);
+		sk_serial_print(failed ? " FAILED\n" : " ok\n");
+	}
+
+	exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+int main(void)
+{
+	for (unsigned char i = 0; i < STRESS_LOCKS; ++i) {
+		locks[i] = sk_sem_create(1);
+	}
+	for (unsigned char i = 0; i < STRESS_WORKERS; ++i) {
+		workers[i] = sk_task_create_static(worker, 1, worker_stacks[i],
+						   sizeof worker_stacks[i]);
+	}
+	sk_task_create_static(monitor, 2, monitor_stack, sizeof monitor_stack);
+
+	sk_kernel_start();
+}
@@ -0,0 +1,109 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Software timers example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * Two periodic timers and a one-shot watchdog share the timer service task
+ * instead of each needing a task sleeping in a loop. The worker task kicks
+ * the watchdog a few times, then stops and lets it expire.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Contains functions starting with sk_timer */
+#include <sk/timer.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+#define WATCHDOG_TICKS 300
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+
+sk_task *worker = NULL;
+sk_timer *fast = NULL;
+sk_timer *heartbeat = NULL;
+sk_timer *watchdog = NULL;
+
+volatile unsigned short fast_count = 0;
+
+void fast_expired(void *arg)
+{
+	(void)arg;
+	fast_count++;
+}
+
+void heartbeat_expired(void *arg)
+{
+	(void)arg;
+	sk_serial_print("Heartbeat, fast timer ran ");
+	sk_serial_print_uint(fast_count);
+	sk_serial_print(" times\n\r");
+}
+
+void watchdog_expired(void *arg)
+{
+	sk_serial_print((const char *)arg);
+}
+
+void func_worker(void)
+{
+	for (;;) {
+		for (unsigned char i = 0; i < 5; ++i) {
+			sk_timer_start(watchdog, WATCHDOG_TICKS, 0);
+			sk_serial_print("Worker: kick\n\r");
+			sk_task_sleep(WATCHDOG_TICKS / 2);
+		}
+		sk_serial_print("Worker: stalling\n\r");
+		sk_task_sleep(WATCHDOG_TICKS * 2);
+	}
+}
+
+int main(void)
+{
+	worker = sk_task_create_static(func_worker, 1, stack1, sizeof stack1);
+
+	fast = sk_timer_create(fast_expired, NULL);
+	heartbeat = sk_timer_create(heartbeat_expired, NULL);
+	watchdog = sk_timer_create(watchdog_expired, "Watchdog expired!\n\r");
+	sk_timer_start(fast, 10, 10);
+	sk_timer_start(heartbeat, 1000, 1000);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,130 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Publish/subscribe topics example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * A sensor task publishes a reading every 50 ticks. A logger queues every
+ * reading, a slow display only follows the latest one and reports how many
+ * it skipped from the sequence numbers. Both are served by one publish call.
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Contains functions starting with sk_topic */
+#include <sk/topic.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+#define LOG_QUEUE_SZ 4
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack3[SKIRT_TASK_STACK_SZ];
+
+sk_task *sensor = NULL;
+sk_task *logger = NULL;
+sk_task *display = NULL;
+sk_topic *readings = NULL;
+
+/* Values are passed by pointer, each slot is reused after 4 readings. */
+unsigned short samples[LOG_QUEUE_SZ];
+
+void func_sensor(void)
+{
+	unsigned short value = 0;
+	for (unsigned char i = 0;; i = (i + 1) % LOG_QUEUE_SZ) {
+		value += 7;
+		samples[i] = value;
+		sk_topic_publish(readings, &samples[i]);
+		sk_task_sleep(50);
+	}
+}
+
+void func_logger(void)
+{
+	static sk_topic_entry queue[LOG_QUEUE_SZ];
+	sk_topic_sub sub;
+	unsigned short seq;
+
+	sk_topic_subscribe_queue(readings, &sub, queue, LOG_QUEUE_SZ);
+	for (;;) {
+		const unsigned short *value = sk_topic_take(&sub, &seq);
+		sk_serial_print("Logger: #");
+		sk_serial_print_uint(seq);
+		sk_serial_print(" = ");
+		sk_serial_print_uint(*value);
+		sk_serial_print("\n\r");
+	}
+}
+
+void func_display(void)
+{
+	sk_topic_sub sub;
+	unsigned short last = 0;
+	unsigned short seq;
+
+	sk_topic_subscribe(readings, &sub);
+	for (;;) {
+		const unsigned short *value = sk_topic_take(&sub, &seq);
+		unsigned short copy = *value;
+		/* Its slot may have been refilled meanwhile, take a newer one. */
+		if (!sk_topic_valid(&sub, seq)) {
+			continue;
+		}
+		sk_serial_print("Display: ");
+		sk_serial_print_uint(copy);
+		sk_serial_print(", skipped ");
+		sk_serial_print_uint((unsigned short)(seq - last - 1));
+		sk_serial_print("\n\r");
+		last = seq;
+		sk_task_sleep(120);
+	}
+}
+
+int main(void)
+{
+	readings = sk_topic_create();
+
+	sensor = sk_task_create_static(func_sensor, 1, stack1, sizeof stack1);
+	logger = sk_task_create_static(func_logger, 2, stack2, sizeof stack2);
+	display = sk_task_create_static(func_display, 2, stack3, sizeof stack3);
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,121 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief TWI (I2C) driver example with SKIRT
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ *
+ * T1 writes a counter to a 24C02-like EEPROM (address 0x50) and reads it
+ * back, T2 reads the temperature register of a LM75-like sensor (address
+ * 0x48). Both share the bus, their transactions are queued by the driver and
+ * neither task runs while bytes are shifted. Runs under simavr with its
+ * i2c_eeprom part attached at 0x50 (T2 then reports a NACK).
+ */
+
+/* Contains functions starting with sk_task */
+#include <sk/task.h>
+/* Contains functions starting with sk_twi */
+#include <sk/twi.h>
+/* For sending data on serial port. */
+#include <sk/serial.h>
+
+#define EEPROM_ADDR 0x50
+#define SENSOR_ADDR 0x48
+
+sk_stack_t stack1[SKIRT_TASK_STACK_SZ];
+sk_stack_t stack2[SKIRT_TASK_STACK_SZ];
+
+sk_task *t1 = NULL;
+sk_task *t2 = NULL;
+
+void func_t1(void)
+{
+	for (unsigned char count = 0;; ++count) {
+		/* Memory address then data, in a single write. */
+		unsigned char cell = 0x10;
+		unsigned char data[2] = { cell, count };
+		sk_twi_seg write = { data, sizeof data, SK_TWI_WRITE };
+		sk_twi_xfer xfer = { .segs = &write, .nsegs = 1,
+				     .addr = EEPROM_ADDR };
+
+		if (sk_twi_transfer(&xfer) != SK_TWI_OK) {
+			sk_serial_print("T1: EEPROM write failed\n\r");
+		}
+		/* Write cycle, the EEPROM does not answer meanwhile. */
+		sk_task_sleep(5);
+
+		unsigned char value = 0;
+		if (sk_twi_write_read(EEPROM_ADDR, &cell, 1, &value, 1) ==
+		    SK_TWI_OK) {
+			sk_serial_print("T1: read back ");
+			sk_serial_print_uint(value);
+			sk_serial_print("\n\r");
+		}
+		sk_task_sleep(100);
+	}
+}
+
+void func_t2(void)
+{
+	for (;;) {
+		unsigned char reg = 0;
+		unsigned char temp[2];
+		sk_twi_status status =
+			sk_twi_write_read(SENSOR_ADDR, &reg, 1, temp, 2);
+
+		if (status == SK_TWI_OK) {
+			sk_serial_print("T2: ");
+			sk_serial_print_uint(temp[0]);
+			sk_serial_print(" C\n\r");
+		} else {
+			sk_serial_print("T2: sensor error ");
+			sk_serial_print_uint(status);
+			sk_serial_print("\n\r");
+		}
+		sk_task_sleep(250);
+	}
+}
+
+int main(void)
+{
+	t1 = sk_task_create_static(func_t1, 2, stack1, sizeof stack1);
+	t2 = sk_task_create_static(func_t2, 1, stack2, sizeof stack2);
+
+	sk_twi_init();
+
+	/* Start kernel. */
+	sk_kernel_start();
+
+	/* Never reached. */
+}
@@ -0,0 +1,270 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Active objects, dispatched by a single kernel task.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/ao.h>
+#include <sk/arch.h>
+
+#ifdef SKIRT_AO
+
+#define SK_AO_QUEUE_MASK (SKIRT_AO_QUEUE_SZ - 1)
+#define SK_EVENT_FREE 0xff
+
+#ifdef SKIRT_ALLOC_STATIC
+static sk_ao ao_pool[SKIRT_AO_MAX] = { 0 };
+static sk_event event_pool[SKIRT_EVENT_MAX] = { 0 };
+static bool event_pool_ready = false;
+
+static inline sk_ao *sk_ao_alloc(void)
+{
+	for (sk_size_t i = 0; i < SKIRT_AO_MAX; ++i) {
+		if (ao_pool[i].dispatch == NULL) {
+			ao_pool[i].subscriptions = 0;
+			ao_pool[i].head = 0;
+			ao_pool[i].tail = 0;
+			ao_pool[i].next = NULL;
+			return &ao_pool[i];
+		}
+	}
+
+	return NULL;
+}
+
+static inline sk_event *sk_event_alloc(void)
+{
+	if (!event_pool_ready) {
+		for (sk_size_t i = 0; i < SKIRT_EVENT_MAX; ++i) {
+			event_pool[i].refs = SK_EVENT_FREE;
+		}
+		event_pool_ready = true;
+	}
+
+	for (sk_size_t i = 0; i < SKIRT_EVENT_MAX; ++i) {
+		if (event_pool[i].refs == SK_EVENT_FREE) {
+			event_pool[i].refs = 0;
+			return &event_pool[i];
+		}
+	}
+
+	return NULL;
+}
+
+static inline void sk_event_free(sk_event *e)
+{
+	SK_ASSERT(e);
+	if (e < event_pool || e > &event_pool[SKIRT_EVENT_MAX - 1]) {
+		SK_PANIC("Provided event is not from the static pool!\n\r");
+	}
+	e->refs = SK_EVENT_FREE;
+}
+#else
+#error "Only SKIRT_ALLOC_STATIC is currently supported!"
+#endif /* SKIRT_ALLOC_STATIC */
+
+static sk_stack_t ao_stack[SKIRT_AO_STACK_SZ];
+static sk_task *ao_dispatcher = NULL;
+/* Sorted by decreasing priority. */
+static sk_ao *volatile ao_head = NULL;
+
+static inline void sk_ao_insert(sk_ao *ao)
+{
+	if (!ao_head || ao_head->priority < ao->priority) {
+		ao->next = ao_head;
+		ao_head = ao;
+		return;
+	}
+
+	sk_ao *tmp = ao_head;
+	while (tmp->next && tmp->next->priority >= ao->priority) {
+		tmp = tmp->next;
+	}
+	ao->next = tmp->next;
+	tmp->next = ao;
+}
+
+/**
+ * @brief Drop a reference to an event, freeing it when unused.
+ * @note Must be called with interrupts disabled.
+ */
+static inline void sk_event_release(sk_event *e)
+{
+	if (e->refs > 0) {
+		e->refs--;
+	}
+	if (e->refs == 0) {
+		sk_event_free(e);
+	}
+}
+
+/* Dispatch one event of the highest priority non-empty queue at a time. */
+static SK_NORETURN void sk_ao_dispatcher_task(void)
+{
+	for (;;) {
+		sk_arch_disable_int();
+		sk_ao *ao = ao_head;
+		while (ao && ao->head == ao->tail) {
+			ao = ao->next;
+		}
+		if (!ao) {
+			sk_task_await();
+			continue;
+		}
+		sk_event *e = ao->queue[ao->head];
+		ao->head = (ao->head + 1) & SK_AO_QUEUE_MASK;
+		sk_arch_enable_int();
+
+		ao->dispatch(ao, e);
+
+		sk_arch_disable_int();
+		sk_event_release(e);
+		sk_arch_enable_int();
+	}
+	SK_VERIFY_NOT_REACHED();
+}
+
+/**
+ * @brief Queue an event, must be called with interrupts disabled.
+ */
+static inline bool sk_ao_enqueue(sk_ao *ao, sk_event *e)
+{
+	unsigned char next = (ao->tail + 1) & SK_AO_QUEUE_MASK;
+	if (next == ao->head) {
+		return false;
+	}
+
+	ao->queue[ao->tail] = e;
+	ao->tail = next;
+	e->refs++;
+	sk_task_wake_isr(ao_dispatcher);
+
+	return true;
+}
+
+sk_ao *sk_ao_create(sk_ao_dispatch dispatch, short priority, void *arg)
+{
+	SK_ASSERT(dispatch);
+
+	if (!ao_dispatcher) {
+		ao_dispatcher = sk_task_create_static(sk_ao_dispatcher_task,
+						      SKIRT_AO_PRIO, ao_stack,
+						      sizeof ao_stack);
+	}
+
+	sk_arch_disable_int();
+	sk_ao *ao = sk_ao_alloc();
+	SK_ASSERT(ao);
+	ao->dispatch = dispatch;
+	ao->arg = arg;
+	ao->priority = priority;
+	sk_ao_insert(ao);
+	sk_arch_enable_int();
+
+	return ao;
+}
+
+sk_event *sk_event_new(unsigned char sig)
+{
+	sk_int_state_t state = sk_arch_save_int();
+	sk_event *e = sk_event_alloc();
+	if (e) {
+		e->sig = sig;
+	}
+	sk_arch_restore_int(state);
+
+	return e;
+}
+
+bool sk_ao_post(sk_ao *ao, sk_event *e)
+{
+	SK_ASSERT(ao);
+	SK_ASSERT(e);
+
+	sk_int_state_t state = sk_arch_save_int();
+	bool posted = sk_ao_enqueue(ao, e);
+	if (!posted && e->refs == 0) {
+		sk_event_free(e);
+	}
+	sk_arch_restore_int(state);
+
+	return posted;
+}
+
+unsigned char sk_ao_publish(sk_event *e)
+{
+	SK_ASSERT(e);
+	SK_ASSERT(e->sig < SK_AO_SIG_MAX);
+
+	unsigned char count = 0;
+	unsigned long mask = 1UL << e->sig;
+
+	sk_int_state_t state = sk_arch_save_int();
+	for (sk_ao *ao = ao_head; ao; ao = ao->next) {
+		if ((ao->subscriptions & mask) && sk_ao_enqueue(ao, e)) {
+			count++;
+		}
+	}
+	if (e->refs == 0) {
+		sk_event_free(e);
+	}
+	sk_arch_restore_int(state);
+
+	return count;
+}
+
+void sk_ao_subscribe(sk_ao *ao, unsigned char sig)
+{
+	SK_ASSERT(ao);
+	SK_ASSERT(sig < SK_AO_SIG_MAX);
+
+	sk_arch_disable_int();
+	ao->subscriptions |= 1UL << sig;
+	sk_arch_enable_int();
+}
+
+void sk_ao_unsubscribe(sk_ao *ao, unsigned char sig)
+{
+	SK_ASSERT(ao);
+	SK_ASSERT(sig < SK_AO_SIG_MAX);
+
+	sk_arch_disable_int();
+	ao->subscriptions &= ~(1UL << sig);
+	sk_arch_enable_int();
+}
+
+#endif /* SKIRT_AO */
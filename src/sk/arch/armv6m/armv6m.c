@@ -0,0 +1,460 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief ARMv6-M (Cortex-M0/M0+) specific code.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/arch.h>
+#include <sk/serial.h>
+#include <sk/profile.h>
+#include <sk/latency.h>
+#include <sk/ipc.h>
+
+#ifdef SKIRT_VANITY
+static const char *const panic_art[5] = {
+	" _  _______ ____  _   _ _____ _       ____   _    _   _ ___ ____\n\r",
+	"| |/ / ____|  _ \\| \\ | | ____| |     |  _ \\ / \\  | \\ | |_ _/ ___|\n\r",
+	"| ' /|  _| | |_) |  \\| |  _| | |     | |_) / _ \\ |  \\| || | |    \n\r",
+	"| . \\| |___|  _ <| |\\  | |___| |___  |  __/ ___ \\| |\\  || | |___\n\r",
+	"|_|\\_\\_____|_| \\_\\_| \\_|_____|_____| |_| /_/   \\_\\_| \\_|___\\____|\n\r\n\r> "
+};
+#else
+static const char *const panic_art[5] = { "\n\r", "\n\r",
+					  "-- KERNEL PANIC --\n\r", "\n\r",
+					  "> " };
+#endif /* SKIRT_VANITY */
+
+extern sk_task *volatile task_current;
+extern volatile bool task_resched;
+extern volatile sk_size_t kernel_ticks;
+
+/* Task whose registers are in the CPU, task_current is the elected one. */
+static sk_task *volatile task_running;
+
+/* Provided by the board linker script. */
+extern unsigned long _sidata, _sdata, _edata, _sbss, _ebss, _estack;
+
+extern int main(void);
+
+#ifdef SKIRT_STACK_CHECK
+/* SP check catches an overflow in progress, the painted bottom byte one that already unwound. */
+#define stack_overflow_protection(sp, task)                           \
+	do {                                                          \
+		if (sp < task->stack ||                               \
+		    task->stack[0] != SKIRT_STACK_PATTERN) {          \
+			SK_PANIC("Stack overflow!\n\r");              \
+		}                                                     \
+	} while (0)
+#else
+#define stack_overflow_protection(sp, task) \
+	do {                                \
+	} while (0)
+#endif /* SKIRT_STACK_CHECK */
+
+/* Switch once every handler returned if another task was elected. */
+static inline void sk_armv6m_pend_switch(void)
+{
+	if (task_current != task_running) {
+		SK_SCB_ICSR = SK_ICSR_PENDSVSET;
+	}
+}
+
+// ------------------
+// Exception handlers
+// ------------------
+
+SK_NORETURN void sk_armv6m_reset(void)
+{
+	unsigned long *src = &_sidata;
+	for (unsigned long *dst = &_sdata; dst < &_edata;) {
+		*dst++ = *src++;
+	}
+	for (unsigned long *dst = &_sbss; dst < &_ebss;) {
+		*dst++ = 0;
+	}
+
+	main();
+
+	for (;;)
+		;
+}
+
+static void sk_armv6m_unhandled(void)
+{
+	SK_PANIC("Unhandled interrupt!\n\r");
+}
+
+static void sk_armv6m_hardfault(void)
+{
+	SK_PANIC("Hard fault!\n\r");
+}
+
+#ifdef SKIRT_SIG
+/* Entered by exception return with the interrupted context right above. */
+static SK_NAKED void sk_armv6m_sig_trampoline(void)
+{
+	__asm__ __volatile__(
+		"cpsid  i                                       \n\t"
+		"bl     sk_sig_run                              \n\t"
+		/* SVC escalates to HardFault with interrupts disabled. */
+		"cpsie  i                                       \n\t"
+		"svc    %0                                      \n\t" ::"i"(
+			SK_SVC_SIGRETURN));
+}
+
+/* Stack a context entering sk_armv6m_sig_trampoline() if needed. */
+static void sk_armv6m_sig_frame(sk_task *task)
+{
+	if (!sk_sig_need_frame(task)) {
+		return;
+	}
+	SK_ASSERT(task->sp - 64 >= task->stack);
+	task->sp -= 64;
+	unsigned long *frame = (unsigned long *)(task->sp + 32);
+	for (int i = 0; i < 6; ++i) {
+		frame[i] = 0; /* r0-r3, r12 and lr */
+	}
+	frame[6] = (unsigned long)sk_armv6m_sig_trampoline & ~1UL;
+	frame[7] = 0x01000000UL; /* Thumb state */
+}
+#else
+#define sk_armv6m_sig_frame(task) \
+	do {                      \
+	} while (0)
+#endif /* SKIRT_SIG */
+
+/* Called by PendSV with the context of task_running saved at sp, returns the context to restore. */
+__attribute__((used)) sk_stack_t *sk_armv6m_switch(sk_stack_t *sp)
+{
+	/* A task calling sk_task_exit() is freed before its last switch. */
+	if (task_running->stack) {
+		stack_overflow_protection(sp, task_running);
+	}
+	task_running->sp = sp;
+	task_running = task_current;
+	sk_armv6m_sig_frame(task_running);
+	return task_running->sp;
+}
+
+/*
+ * The CPU stacked r0-r3, r12, lr, pc and xPSR on the task stack, r4-r11 are
+ * saved below them. Interrupts are disabled while task_running and
+ * task_current are exchanged.
+ */
+static SK_NAKED void sk_armv6m_pendsv(void)
+{
+	__asm__ __volatile__(
+		"cpsid  i                                       \n\t"
+		"mrs    r0, psp                                 \n\t"
+		"subs   r0, #32                                 \n\t"
+		"mov    r1, r0                                  \n\t"
+		"stmia  r1!, {r4-r7}                            \n\t"
+		"mov    r4, r8                                  \n\t"
+		"mov    r5, r9                                  \n\t"
+		"mov    r6, r10                                 \n\t"
+		"mov    r7, r11                                 \n\t"
+		"stmia  r1!, {r4-r7}                            \n\t"
+		/* r1 keeps MSP 8-byte aligned for the C call. */
+		"push   {r1, lr}                                \n\t"
+		"bl     sk_armv6m_switch                        \n\t"
+		"pop    {r1, r2}                                \n\t"
+		"adds   r0, #16                                 \n\t"
+		"ldmia  r0!, {r4-r7}                            \n\t"
+		"mov    r8, r4                                  \n\t"
+		"mov    r9, r5                                  \n\t"
+		"mov    r10, r6                                 \n\t"
+		"mov    r11, r7                                 \n\t"
+		"msr    psp, r0                                 \n\t"
+		"subs   r0, #32                                 \n\t"
+		"ldmia  r0!, {r4-r7}                            \n\t"
+		"cpsie  i                                       \n\t"
+		"bx     r2                                      \n\t");
+}
+
+/* Called by SVC with the stacked frame, returns the context to restore on SK_SVC_START and SK_SVC_SIGRETURN. */
+__attribute__((used)) sk_stack_t *sk_armv6m_svc(unsigned long *frame)
+{
+	/* Low byte of the SVC instruction, right before the stacked PC. */
+	unsigned char num = ((const unsigned char *)frame[6])[-2];
+
+	switch (num) {
+	case SK_SVC_START:
+		SK_ASSERT(!task_running);
+		task_running = task_current;
+		sk_armv6m_sig_frame(task_running);
+		/* Start counting, the tick interrupt is already configured. */
+		SK_SYST_CSR |= 1;
+		return task_running->sp;
+	case SK_SVC_YIELD:
+		if (!task_running) {
+			return NULL;
+		}
+		sk_arch_disable_int();
+		SK_CS_ENTER();
+		sk_task_schedule();
+		SK_CS_EXIT(SK_CS_YIELD);
+		sk_armv6m_pend_switch();
+		sk_arch_enable_int();
+		return NULL;
+#ifdef SKIRT_SIG
+	case SK_SVC_SIGRETURN:
+		/* The interrupted context is right above the SVC frame. */
+		return (sk_stack_t *)(frame + 8);
+#endif /* SKIRT_SIG */
+	default:
+		SK_PANIC("Unknown SVC!\n\r");
+	}
+}
+
+static SK_NAKED void sk_armv6m_svc_entry(void)
+{
+	__asm__ __volatile__(
+		/* Frame is on the stack the caller was using. */
+		"movs   r0, #4                                  \n\t"
+		"mov    r1, lr                                  \n\t"
+		"tst    r0, r1                                  \n\t"
+		"beq    1f                                      \n\t"
+		"mrs    r0, psp                                 \n\t"
+		"b      2f                                      \n\t"
+		"1:                                             \n\t"
+		"mrs    r0, msp                                 \n\t"
+		"2:                                             \n\t"
+		"push   {r1, lr}                                \n\t"
+		"bl     sk_armv6m_svc                           \n\t"
+		"pop    {r1, r2}                                \n\t"
+		"cmp    r0, #0                                  \n\t"
+		"beq    3f                                      \n\t"
+		/* Restore the returned context, back to thread mode on PSP. */
+		"adds   r0, #16                                 \n\t"
+		"ldmia  r0!, {r4-r7}                            \n\t"
+		"mov    r8, r4                                  \n\t"
+		"mov    r9, r5                                  \n\t"
+		"mov    r10, r6                                 \n\t"
+		"mov    r11, r7                                 \n\t"
+		"msr    psp, r0                                 \n\t"
+		"subs   r0, #32                                 \n\t"
+		"ldmia  r0!, {r4-r7}                            \n\t"
+		"movs   r2, #2                                  \n\t"
+		"mvns   r2, r2                                  \n\t" /* 0xFFFFFFFD */
+		"3:                                             \n\t"
+		"bx     r2                                      \n\t");
+}
+
+static void sk_armv6m_systick(void)
+{
+	sk_arch_disable_int();
+#ifdef SKIRT_PROFILE
+	/* The frame stacked on entry sits where PendSV would save the context. */
+	sk_stack_t *psp;
+	__asm__ __volatile__("mrs %0, psp" : "=r"(psp));
+	sk_profile_sample(sk_arch_context_pc(psp - 32), task_running);
+#endif /* SKIRT_PROFILE */
+	kernel_ticks++;
+	SK_CS_ENTER();
+	sk_task_switch();
+	SK_CS_EXIT(SK_CS_TICK);
+	sk_armv6m_pend_switch();
+	sk_arch_enable_int();
+}
+
+/* Device interrupts, SKIRT_IRQ(IRQn_Handler, name) overrides them. */
+#define SK_ARMV6M_IRQ(n)              \
+	void IRQ##n##_Handler(void) \
+		__attribute__((weak, alias("sk_armv6m_unhandled")))
+SK_ARMV6M_IRQ(0);
+SK_ARMV6M_IRQ(1);
+SK_ARMV6M_IRQ(2);
+SK_ARMV6M_IRQ(3);
+SK_ARMV6M_IRQ(4);
+SK_ARMV6M_IRQ(5);
+SK_ARMV6M_IRQ(6);
+SK_ARMV6M_IRQ(7);
+SK_ARMV6M_IRQ(8);
+SK_ARMV6M_IRQ(9);
+SK_ARMV6M_IRQ(10);
+SK_ARMV6M_IRQ(11);
+SK_ARMV6M_IRQ(12);
+SK_ARMV6M_IRQ(13);
+SK_ARMV6M_IRQ(14);
+SK_ARMV6M_IRQ(15);
+SK_ARMV6M_IRQ(16);
+SK_ARMV6M_IRQ(17);
+SK_ARMV6M_IRQ(18);
+SK_ARMV6M_IRQ(19);
+SK_ARMV6M_IRQ(20);
+SK_ARMV6M_IRQ(21);
+SK_ARMV6M_IRQ(22);
+SK_ARMV6M_IRQ(23);
+SK_ARMV6M_IRQ(24);
+SK_ARMV6M_IRQ(25);
+SK_ARMV6M_IRQ(26);
+SK_ARMV6M_IRQ(27);
+SK_ARMV6M_IRQ(28);
+SK_ARMV6M_IRQ(29);
+SK_ARMV6M_IRQ(30);
+SK_ARMV6M_IRQ(31);
+
+typedef void (*sk_armv6m_handler)(void);
+
+/* Placed at the start of flash by the board linker script. */
+__attribute__((section(".vectors"), used)) static const struct {
+	unsigned long *estack;
+	sk_armv6m_handler handlers[15 + 32];
+} sk_armv6m_vectors = {
+	&_estack,
+	{
+		sk_armv6m_reset,
+		sk_armv6m_unhandled, /* NMI */
+		sk_armv6m_hardfault,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		sk_armv6m_svc_entry,
+		NULL,
+		NULL,
+		sk_armv6m_pendsv,
+		sk_armv6m_systick,
+		IRQ0_Handler,
+		IRQ1_Handler,
+		IRQ2_Handler,
+		IRQ3_Handler,
+		IRQ4_Handler,
+		IRQ5_Handler,
+		IRQ6_Handler,
+		IRQ7_Handler,
+		IRQ8_Handler,
+		IRQ9_Handler,
+		IRQ10_Handler,
+		IRQ11_Handler,
+		IRQ12_Handler,
+		IRQ13_Handler,
+		IRQ14_Handler,
+		IRQ15_Handler,
+		IRQ16_Handler,
+		IRQ17_Handler,
+		IRQ18_Handler,
+		IRQ19_Handler,
+		IRQ20_Handler,
+		IRQ21_Handler,
+		IRQ22_Handler,
+		IRQ23_Handler,
+		IRQ24_Handler,
+		IRQ25_Handler,
+		IRQ26_Handler,
+		IRQ27_Handler,
+		IRQ28_Handler,
+		IRQ29_Handler,
+		IRQ30_Handler,
+		IRQ31_Handler,
+	},
+};
+
+// ------------------
+// Exported symbols
+// ------------------
+
+void sk_arch_stack_init(sk_task_func func, sk_task *task)
+{
+	SK_ASSERT(task->stack_sz > SK_CONTEXT_SZ + 8);
+
+	/* Exception frames are 8-byte aligned. */
+	unsigned long *frame =
+		(unsigned long *)((unsigned long)(task->stack + task->stack_sz) &
+				  ~7UL) -
+		8;
+	for (unsigned i = 0; i < 5; ++i) {
+		frame[i] = 0; /* r0-r3, r12 */
+	}
+	frame[5] = (unsigned long)sk_task_exit; /* LR, returning ends the task */
+	frame[6] = (unsigned long)func & ~1UL; /* PC */
+	frame[7] = 0x01000000UL; /* xPSR, Thumb state */
+
+	/* r4 to r11 are left as they are. */
+	task->sp = (sk_stack_t *)(frame - 8);
+}
+
+void sk_arch_init_preempt(void)
+{
+	/* PendSV and SysTick at the lowest priority, device IRQs preempt them. */
+	SK_SCB_SHPR3 = (SK_SCB_SHPR3 & 0x0000ffffUL) | 0xffff0000UL;
+
+	SK_SYST_RVR = (SK_ARCH_TIMER_PERIOD << SKIRT_ARMV6M_COUNT_SHIFT) - 1;
+	SK_SYST_CVR = 0;
+	/* CPU clock and tick interrupt, enabled by SK_SVC_START. */
+	SK_SYST_CSR = (1UL << 2) | (1UL << 1);
+}
+
+void sk_arch_first_yield(sk_task *task)
+{
+	SK_ASSERT(task == task_current);
+	sk_arch_enable_int();
+	sk_arch_syscall(SK_SVC_START);
+	SK_VERIFY_NOT_REACHED();
+}
+
+void sk_arch_yield(void)
+{
+	SK_CS_ENTER();
+	sk_task_schedule();
+	SK_CS_EXIT(SK_CS_YIELD);
+	sk_armv6m_pend_switch();
+	/* PendSV is taken here, this task resumes after the barrier. */
+	sk_arch_enable_int();
+	__asm__ __volatile__("isb" ::: "memory");
+}
+
+void sk_arch_irq_exit(void)
+{
+	if (task_running && task_resched) {
+		sk_task_schedule();
+		sk_armv6m_pend_switch();
+	}
+}
+
+SK_NORETURN void sk_arch_panic(const char *msg)
+{
+	for (unsigned i = 0; i < 5; ++i) {
+		sk_serial_print(panic_art[i]);
+	}
+	sk_serial_print_P(msg);
+	for (;;)
+		;
+}
@@ -0,0 +1,135 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief BBC micro:bit (nRF51822, Cortex-M0) board support.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ * @note Also runs under qemu-system-arm -M microbit.
+ */
+
+#include <sk/arch.h>
+#include <sk/serial.h>
+#include <sk/irq.h>
+#include <sk/link.h>
+
+/* UART0, P0.24/P0.25 go to the USB serial port of the interface chip. */
+#define NRF_UART0_REG(off) (*(volatile unsigned long *)(0x40002000UL + (off)))
+#define NRF_UART0_STARTRX NRF_UART0_REG(0x000)
+#define NRF_UART0_STARTTX NRF_UART0_REG(0x008)
+#define NRF_UART0_RXDRDY NRF_UART0_REG(0x108)
+#define NRF_UART0_TXDRDY NRF_UART0_REG(0x11C)
+#define NRF_UART0_INTENSET NRF_UART0_REG(0x304)
+#define NRF_UART0_ENABLE NRF_UART0_REG(0x500)
+#define NRF_UART0_PSELTXD NRF_UART0_REG(0x50C)
+#define NRF_UART0_PSELRXD NRF_UART0_REG(0x514)
+#define NRF_UART0_RXD NRF_UART0_REG(0x518)
+#define NRF_UART0_TXD NRF_UART0_REG(0x51C)
+#define NRF_UART0_BAUDRATE NRF_UART0_REG(0x524)
+
+#define NRF_UART0_IRQ 2
+#define NRF_UART_INT_RXDRDY (1UL << 2)
+#define NRF_UART_INT_TXDRDY (1UL << 7)
+
+#define MICROBIT_TX_PIN 24
+#define MICROBIT_RX_PIN 25
+
+/* BAUDRATE is baud * 2^32 / 16MHz, rounded to the 4096 steps the UART has. */
+#define NRF_UART_BAUD(baud) \
+	((((unsigned long long)(baud) << 32) / 16000000ULL + 0x800) & 0xfffff000UL)
+
+void sk_arch_serial_init(void)
+{
+	NRF_UART0_PSELTXD = MICROBIT_TX_PIN;
+	NRF_UART0_PSELRXD = MICROBIT_RX_PIN;
+	NRF_UART0_BAUDRATE = (unsigned long)NRF_UART_BAUD(SKIRT_SERIAL_BAUD);
+	NRF_UART0_ENABLE = 4;
+	NRF_UART0_STARTTX = 1;
+}
+
+void sk_arch_serial_putc(char c)
+{
+	NRF_UART0_TXDRDY = 0;
+	NRF_UART0_TXD = (unsigned char)c;
+	/* Wait for the byte to leave, there is no transmit FIFO. */
+	while (!NRF_UART0_TXDRDY)
+		;
+}
+
+#ifdef SKIRT_LINK
+/* TXDRDY only fires once a byte is out, the first one is written by hand. */
+static volatile bool link_tx_busy = false;
+
+SKIRT_IRQ(IRQ2_Handler, link_uart_irq)
+
+static void sk_microbit_link_irq(void *arg)
+{
+	(void)arg;
+	if (NRF_UART0_RXDRDY) {
+		NRF_UART0_RXDRDY = 0;
+		sk_link_rx_isr((unsigned char)NRF_UART0_RXD);
+	}
+	if (NRF_UART0_TXDRDY) {
+		NRF_UART0_TXDRDY = 0;
+		int c = link_tx_busy ? sk_link_tx_isr() : -1;
+		if (c < 0) {
+			link_tx_busy = false;
+		} else {
+			NRF_UART0_TXD = (unsigned char)c;
+		}
+	}
+}
+
+void sk_arch_link_init(void)
+{
+	sk_irq_attach_handler(&link_uart_irq, sk_microbit_link_irq, NULL);
+	NRF_UART0_RXDRDY = 0;
+	NRF_UART0_TXDRDY = 0;
+	NRF_UART0_INTENSET = NRF_UART_INT_RXDRDY | NRF_UART_INT_TXDRDY;
+	NRF_UART0_STARTRX = 1;
+	SK_NVIC_ISER = 1UL << NRF_UART0_IRQ;
+}
+
+void sk_arch_link_tx_start(void)
+{
+	if (link_tx_busy) {
+		return;
+	}
+	int c = sk_link_tx_isr();
+	if (c >= 0) {
+		link_tx_busy = true;
+		NRF_UART0_TXD = (unsigned char)c;
+	}
+}
+#endif /* SKIRT_LINK */
@@ -0,0 +1,249 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief AVR continuous ADC sampling, Timer0 paces timer-triggered mode.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/adc.h>
+#include <sk/arch.h>
+#include <sk/irq.h>
+
+#ifdef SKIRT_ADC
+
+/* ADC clock prescaler (ADPS2:0), /128 keeps it within 50-200kHz at 16MHz. */
+#ifndef SKIRT_ADC_PRESCALER
+#define SKIRT_ADC_PRESCALER 7
+#endif /* SKIRT_ADC_PRESCALER */
+
+/* Voltage reference (REFS1:0 bits of ADMUX), AVcc by default. */
+#ifndef SKIRT_ADC_REF
+#define SKIRT_ADC_REF (1 << REFS0)
+#endif /* SKIRT_ADC_REF */
+
+/* ADTS2:0 in ADCSRB, 0 is free running. */
+#define SK_ADC_ADTS_MASK 0x07
+#define SK_ADC_ADTS_TIMER0 ((1 << ADTS1) | (1 << ADTS0))
+
+/* MUX5 in ADCSRB selects channels 8 to 15 on the ATmega2560. */
+#define SK_ADC_MUX5 3
+
+#define SK_ADC_NONE 0xff
+
+extern sk_task *volatile task_current;
+
+static unsigned short adc_blocks[2][SKIRT_ADC_BLOCK];
+static unsigned char adc_seq[SK_ADC_SEQ_MAX];
+static unsigned char adc_count;
+static bool adc_free_running;
+static bool adc_timer = false;
+
+/* Only used by the ADC interrupt once started. */
+/* Block being filled and next sample in it. */
+static unsigned char adc_fill;
+static unsigned char adc_pos;
+/* Sequence index of the conversion in progress, of ADMUX and of the next
+ * sample to store. */
+static unsigned char adc_running;
+static unsigned char adc_muxed;
+static unsigned char adc_expect;
+
+/* Shared with the consumer task. */
+static volatile unsigned char adc_ready = SK_ADC_NONE;
+static volatile unsigned char adc_held = SK_ADC_NONE;
+static volatile unsigned short adc_overruns = 0;
+static sk_task *volatile adc_task = NULL;
+
+SKIRT_IRQ(ADC_vect, adc_irq)
+
+static unsigned char sk_adc_next(unsigned char index)
+{
+	return index + 1 == adc_count ? 0 : index + 1;
+}
+
+static void sk_adc_mux(unsigned char index)
+{
+	unsigned char channel = adc_seq[index];
+#ifdef __AVR_ATmega2560__
+	ADCSRB = (ADCSRB & ~(1 << SK_ADC_MUX5)) |
+		 ((channel & 0x08) ? (1 << SK_ADC_MUX5) : 0);
+	channel &= 0x07;
+#endif /* __AVR_ATmega2560__ */
+	ADMUX = SKIRT_ADC_REF | (channel & 0x0f);
+}
+
+static void sk_adc_isr(void *arg)
+{
+	unsigned short sample = ADC;
+	unsigned char index = adc_running;
+
+	(void)arg;
+	if (adc_free_running) {
+		/* The next conversion already started with the current ADMUX,
+		 * a new one only applies to the conversion after it. */
+		adc_running = adc_muxed;
+		adc_muxed = sk_adc_next(adc_muxed);
+		sk_adc_mux(adc_muxed);
+	} else {
+		/* Conversions start on the rising edge of the compare flag. */
+		TIFR0 = (1 << OCF0A);
+		adc_muxed = sk_adc_next(adc_muxed);
+		sk_adc_mux(adc_muxed);
+		adc_running = adc_muxed;
+	}
+
+	/* Free running converts channels[0] twice when starting. */
+	if (index != adc_expect) {
+		return;
+	}
+	adc_expect = sk_adc_next(adc_expect);
+
+	adc_blocks[adc_fill][adc_pos++] = sample;
+	if (adc_pos < SKIRT_ADC_BLOCK) {
+		return;
+	}
+	adc_pos = 0;
+
+	unsigned char other = adc_fill ^ 1;
+	if (adc_held == other || adc_ready == other) {
+		/* Nowhere to go, this block is filled again. */
+		if (adc_overruns < 0xffff) {
+			adc_overruns++;
+		}
+		return;
+	}
+	adc_ready = adc_fill;
+	adc_fill = other;
+	if (adc_task) {
+		sk_task_wake_isr(adc_task);
+	}
+}
+
+void sk_adc_start(const unsigned char *channels, unsigned char count,
+		  unsigned short rate)
+{
+	SK_ASSERT(channels);
+	SK_ASSERT(count && count <= SK_ADC_SEQ_MAX);
+	SK_ASSERT(!(SKIRT_ADC_BLOCK % count));
+
+	sk_adc_stop();
+
+	sk_int_state_t state = sk_arch_save_int();
+	for (unsigned char i = 0; i < count; ++i) {
+		adc_seq[i] = channels[i];
+	}
+	adc_count = count;
+	adc_free_running = !rate;
+	adc_fill = 0;
+	adc_pos = 0;
+	adc_running = 0;
+	adc_muxed = 0;
+	adc_expect = 0;
+	adc_ready = SK_ADC_NONE;
+	adc_held = SK_ADC_NONE;
+	adc_overruns = 0;
+	sk_irq_attach_handler(&adc_irq, sk_adc_isr, NULL);
+	sk_adc_mux(0);
+
+	if (adc_free_running) {
+		ADCSRB &= ~SK_ADC_ADTS_MASK;
+		ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADATE) |
+			 (1 << ADIF) | (1 << ADIE) | SKIRT_ADC_PRESCALER;
+		sk_arch_restore_int(state);
+		return;
+	}
+
+	/* Timer0 in CTC mode, with the smallest prescaler OCR0A allows. */
+	static const unsigned short prescalers[] = { 1, 8, 64, 256, 1024 };
+	unsigned char cs = 0;
+	unsigned long top = F_CPU / rate;
+	while (top > 256 && cs < sizeof prescalers / sizeof *prescalers - 1) {
+		top = F_CPU / prescalers[++cs] / rate;
+	}
+	SK_ASSERT(top >= 1 && top <= 256);
+
+	ADCSRB = (ADCSRB & ~SK_ADC_ADTS_MASK) | SK_ADC_ADTS_TIMER0;
+	ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIF) | (1 << ADIE) |
+		 SKIRT_ADC_PRESCALER;
+	TCCR0A = (1 << WGM01);
+	OCR0A = (unsigned char)(top - 1);
+	TCNT0 = 0;
+	TIFR0 = (1 << OCF0A);
+	/* CS02:0 is the prescaler index + 1. */
+	TCCR0B = cs + 1;
+	adc_timer = true;
+	sk_arch_restore_int(state);
+}
+
+void sk_adc_stop(void)
+{
+	sk_int_state_t state = sk_arch_save_int();
+	ADCSRA = (1 << ADIF);
+	if (adc_timer) {
+		TCCR0B = 0;
+		adc_timer = false;
+	}
+	adc_ready = SK_ADC_NONE;
+	sk_arch_restore_int(state);
+}
+
+const unsigned short *sk_adc_wait(void)
+{
+	SK_ASSERT(task_current);
+
+	sk_arch_disable_int();
+	adc_held = SK_ADC_NONE;
+	while (adc_ready == SK_ADC_NONE) {
+		adc_task = task_current;
+		sk_task_await();
+		sk_arch_disable_int();
+	}
+	adc_task = NULL;
+	adc_held = adc_ready;
+	adc_ready = SK_ADC_NONE;
+	sk_arch_enable_int();
+
+	return adc_blocks[adc_held];
+}
+
+unsigned short sk_adc_overruns(void)
+{
+	sk_int_state_t state = sk_arch_save_int();
+	unsigned short overruns = adc_overruns;
+	sk_arch_restore_int(state);
+	return overruns;
+}
+
+#endif /* SKIRT_ADC */
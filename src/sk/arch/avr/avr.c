@@ -40,43 +40,78 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include <sk/arch.h>
 #include <sk/serial.h>
+#include <sk/profile.h>
+#include <sk/latency.h>
+#include <sk/irq.h>
+#include <sk/link.h>
+#include <sk/ipc.h>
 
+/* Banner lines are kept in flash, like every panic message. */
 #ifdef SKIRT_VANITY
-const char *const panic_art[5] = {
-	" _  _______ ____  _   _ _____ _       ____   _    _   _ ___ ____\n\r",
-	"| |/ / ____|  _ \\| \\ | | ____| |     |  _ \\ / \\  | \\ | |_ _/ ___|\n\r",
-	"| ' /|  _| | |_) |  \\| |  _| | |     | |_) / _ \\ |  \\| || | |    \n\r",
-	"| . \\| |___|  _ <| |\\  | |___| |___  |  __/ ___ \\| |\\  || | |___\n\r",
-	"|_|\\_\\_____|_| \\_\\_| \\_|_____|_____| |_| /_/   \\_\\_| \\_|___\\____|\n\r\n\r> "
-};
+static const char panic_art0[] PROGMEM =
+	" _  _______ ____  _   _ _____ _       ____   _    _   _ ___ ____\n\r";
+static const char panic_art1[] PROGMEM =
+	"| |/ / ____|  _ \\| \\ | | ____| |     |  _ \\ / \\  | \\ | |_ _/ ___|\n\r";
+static const char panic_art2[] PROGMEM =
+	"| ' /|  _| | |_) |  \\| |  _| | |     | |_) / _ \\ |  \\| || | |    \n\r";
+static const char panic_art3[] PROGMEM =
+	"| . \\| |___|  _ <| |\\  | |___| |___  |  __/ ___ \\| |\\  || | |___\n\r";
+static const char panic_art4[] PROGMEM =
+	"|_|\\_\\_____|_| \\_\\_| \\_|_____|_____| |_| /_/   \\_\\_| \\_|___\\____|\n\r\n\r> ";
 #else
-const char *const panic_art[5] = { "\n\r", "\n\r", "-- KERNEL PANIC --\n\r",
-				   "\n\r", "> " };
+static const char panic_art0[] PROGMEM = "\n\r";
+static const char panic_art1[] PROGMEM = "\n\r";
+static const char panic_art2[] PROGMEM = "-- KERNEL PANIC --\n\r";
+static const char panic_art3[] PROGMEM = "\n\r";
+static const char panic_art4[] PROGMEM = "> ";
 #endif /* SKIRT_VANITY */
 
+static const char *const panic_art[5] PROGMEM = { panic_art0, panic_art1,
+						  panic_art2, panic_art3,
+						  panic_art4 };
+
 extern sk_task *volatile task_current;
 extern sk_task *volatile task_head;
-
-#define stack_overflow_protection(sp, stack_end)         \
-	do {                                             \
-		if (sp < stack_end) {                    \
-			SK_PANIC("Stack overflow!\n\r"); \
-		}                                        \
+extern volatile bool task_resched;
+extern volatile sk_size_t kernel_ticks;
+
+/* SP of the interrupted code when entering a SKIRT_IRQ() handler. */
+sk_stack_t *volatile irq_sp;
+/* main() stack, reused by the kernel for switching and interrupts once started. */
+sk_stack_t *volatile kernel_sp;
+
+#ifdef SKIRT_STACK_CHECK
+/* SP check catches an overflow in progress, the painted bottom byte one that already unwound. */
+#define stack_overflow_protection(sp, task)                           \
+	do {                                                          \
+		if (sp < task->stack ||                               \
+		    task->stack[0] != SKIRT_STACK_PATTERN) {          \
+			SK_PANIC("Stack overflow!\n\r");              \
+		}                                                     \
 	} while (0)
+#else
+#define stack_overflow_protection(sp, task) \
+	do {                                \
+	} while (0)
+#endif /* SKIRT_STACK_CHECK */
 
-#ifdef __AVR_ATmega328P__
-
-#ifndef F_CPU
-#define F_CPU 16000000
-#endif /* F_CPU */
+/* Both MCUs share the TIMER1 and USART0 register layout. */
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega2560__)
 
 ISR(TIMER1_COMPA_vect, ISR_NAKED)
 {
 	cli();
 	sk_arch_save_context();
-	stack_overflow_protection((sk_stack_t *)SP, task_current->stack);
+	stack_overflow_protection((sk_stack_t *)SP, task_current);
 	task_current->sp = (sk_stack_t *)SP;
+	sk_arch_use_kernel_stack();
+#ifdef SKIRT_PROFILE
+	sk_profile_sample(sk_arch_context_pc(task_current->sp), task_current);
+#endif /* SKIRT_PROFILE */
+	kernel_ticks++;
+	SK_CS_ENTER();
 	sk_task_switch();
+	SK_CS_EXIT(SK_CS_TICK);
 	sk_arch_restore_task_context(task_current);
 	__asm__ __volatile__("reti" ::: "memory");
 }
@@ -98,18 +133,52 @@ SK_NAKED void sk_arch_yield(void)
 {
 	sk_arch_save_context();
 	task_current->sp = (sk_stack_t *)SP;
-	sk_task_switch();
+	sk_arch_use_kernel_stack();
+	SK_CS_ENTER();
+	sk_task_schedule();
+	SK_CS_EXIT(SK_CS_YIELD);
 	SK_ASSERT(task_current);
 	sk_arch_restore_task_context(task_current);
 	__asm__ __volatile__("sei\t\nret");
 }
 
+#ifdef SKIRT_SIG
+/* Entered through the context pushed by sk_arch_sig_prepare(), with
+ * interrupts enabled and the interrupted context right above. */
+SK_NAKED void sk_arch_sig_trampoline(void)
+{
+	sk_arch_disable_int();
+	sk_sig_run();
+	sk_arch_restore_context();
+	__asm__ __volatile__("reti" ::: "memory");
+}
+#endif /* SKIRT_SIG */
+
+void sk_arch_irq_enter(void)
+{
+	if (task_current) {
+		stack_overflow_protection(irq_sp, task_current);
+		task_current->sp = irq_sp;
+	}
+}
+
+sk_stack_t *sk_arch_irq_exit(void)
+{
+	if (!task_current) {
+		return irq_sp;
+	}
+	if (task_resched) {
+		sk_task_schedule();
+	}
+	return task_current->sp;
+}
+
 SK_NORETURN void sk_arch_panic(const char *msg)
 {
 	for (unsigned i = 0; i < 5; ++i) {
-		sk_serial_print(panic_art[i]);
+		sk_serial_print_P(sk_arch_pgm_read_ptr(&panic_art[i]));
 	}
-	sk_serial_print(msg);
+	sk_serial_print_P(msg);
 	for (;;)
 		;
 }
@@ -134,3 +203,39 @@ void sk_arch_serial_putc(char c)
 	/* Put data into buffer, sends the data */
 	UDR0 = c;
 }
+
+#ifdef SKIRT_LINK
+#if defined(__AVR_ATmega2560__)
+#define SK_USART_RX_vect USART0_RX_vect
+#define SK_USART_UDRE_vect USART0_UDRE_vect
+#else
+#define SK_USART_RX_vect USART_RX_vect
+#define SK_USART_UDRE_vect USART_UDRE_vect
+#endif
+
+/* One byte per interrupt, never wakes a task so it needs no context switch. */
+ISR(SK_USART_UDRE_vect)
+{
+	int c = sk_link_tx_isr();
+	if (c < 0) {
+		UCSR0B &= ~(1 << UDRIE0);
+	} else {
+		UDR0 = (unsigned char)c;
+	}
+}
+
+/* Wakes the receiving task once a whole frame is in. */
+SKIRT_IRQ(SK_USART_RX_vect, link_rx_irq)
+
+static void sk_avr_link_rx(void *arg)
+{
+	(void)arg;
+	sk_link_rx_isr(UDR0);
+}
+
+void sk_arch_link_init(void)
+{
+	sk_irq_attach_handler(&link_rx_irq, sk_avr_link_rx, NULL);
+	UCSR0B |= (1 << RXCIE0);
+}
+#endif /* SKIRT_LINK */
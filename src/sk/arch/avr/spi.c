@@ -0,0 +1,205 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief AVR SPI master, blocks are shifted by the SPI interrupt.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/spi.h>
+#include <sk/arch.h>
+#include <sk/irq.h>
+
+#ifdef SKIRT_SPI
+
+/* SS must stay an output for the SPI to remain master. */
+#if defined(__AVR_ATmega2560__)
+#define SK_SPI_SS 0
+#define SK_SPI_SCK 1
+#define SK_SPI_MOSI 2
+#else
+#define SK_SPI_SS 2
+#define SK_SPI_SCK 5
+#define SK_SPI_MOSI 3
+#endif
+
+extern sk_task *volatile task_current;
+
+/* Transfers waiting for the bus, in submission order. */
+static sk_spi_xfer *spi_queue = NULL;
+/* Transfer being shifted. */
+static sk_spi_xfer *spi_current = NULL;
+/* Device left selected by SK_SPI_KEEP_CS. */
+static sk_spi_dev *spi_held = NULL;
+static unsigned short spi_pos;
+
+SKIRT_IRQ(SPI_STC_vect, spi_irq)
+
+/* Oldest queued transfer, only from the held device while there is one. */
+static void sk_spi_start_next(void)
+{
+	sk_spi_xfer **link = &spi_queue;
+	while (*link && spi_held && (*link)->dev != spi_held) {
+		link = &(*link)->next;
+	}
+
+	sk_spi_xfer *xfer = *link;
+	spi_current = xfer;
+	if (!xfer) {
+		return;
+	}
+	*link = xfer->next;
+
+	sk_spi_dev *dev = xfer->dev;
+	SPCR = dev->spcr;
+	SPSR = dev->spsr;
+	*dev->cs_port &= ~dev->cs_mask;
+	spi_pos = 0;
+	SPDR = xfer->tx ? xfer->tx[0] : 0xff;
+}
+
+static void sk_spi_isr(void *arg)
+{
+	sk_spi_xfer *xfer = spi_current;
+
+	(void)arg;
+	if (!xfer) {
+		return;
+	}
+
+	unsigned char in = SPDR;
+	if (xfer->rx) {
+		xfer->rx[spi_pos] = in;
+	}
+	if (++spi_pos < xfer->len) {
+		SPDR = xfer->tx ? xfer->tx[spi_pos] : 0xff;
+		return;
+	}
+
+	if (xfer->flags & SK_SPI_KEEP_CS) {
+		spi_held = xfer->dev;
+	} else {
+		spi_held = NULL;
+		*xfer->dev->cs_port |= xfer->dev->cs_mask;
+	}
+	xfer->done = true;
+	if (xfer->task) {
+		sk_task_wake_isr(xfer->task);
+	}
+
+	sk_spi_start_next();
+}
+
+void sk_spi_init(void)
+{
+	sk_irq_attach_handler(&spi_irq, sk_spi_isr, NULL);
+	PORTB |= (1 << SK_SPI_SS);
+	DDRB |= (1 << SK_SPI_SS) | (1 << SK_SPI_SCK) | (1 << SK_SPI_MOSI);
+}
+
+void sk_spi_dev_init(sk_spi_dev *dev, volatile unsigned char *cs_port,
+		     unsigned char cs_bit, unsigned char mode,
+		     unsigned char div)
+{
+	SK_ASSERT(dev);
+	SK_ASSERT(cs_port);
+	SK_ASSERT(div >= 2 && div <= 128 && !(div & (div - 1)));
+
+	dev->cs_port = cs_port;
+	dev->cs_mask = 1 << cs_bit;
+
+	/* SPR1:0 gives F_CPU / 4, 16, 64 or 128, SPI2X doubles the first three. */
+	unsigned char log = 0;
+	while ((1 << log) < div) {
+		log++;
+	}
+	unsigned char spr = log == 7 ? 3 : (log - 1) / 2;
+	bool x2 = log != 7 && (log & 1);
+
+	dev->spcr = (1 << SPIE) | (1 << SPE) | (1 << MSTR) |
+		    ((mode & 0x03) << CPHA) |
+		    ((mode & SK_SPI_LSB_FIRST) ? (1 << DORD) : 0) | spr;
+	dev->spsr = x2 ? (1 << SPI2X) : 0;
+
+	/* DDRx is right below PORTx on AVR. */
+	sk_int_state_t state = sk_arch_save_int();
+	*cs_port |= dev->cs_mask;
+	*(cs_port - 1) |= dev->cs_mask;
+	sk_arch_restore_int(state);
+}
+
+void sk_spi_submit(sk_spi_xfer *xfer)
+{
+	SK_ASSERT(xfer);
+	SK_ASSERT(xfer->dev);
+	SK_ASSERT(xfer->len);
+
+	xfer->done = false;
+	xfer->task = NULL;
+	xfer->next = NULL;
+
+	sk_int_state_t state = sk_arch_save_int();
+	sk_spi_xfer **link = &spi_queue;
+	while (*link) {
+		link = &(*link)->next;
+	}
+	*link = xfer;
+	if (!spi_current) {
+		sk_spi_start_next();
+	}
+	sk_arch_restore_int(state);
+}
+
+void sk_spi_wait(sk_spi_xfer *xfer)
+{
+	SK_ASSERT(xfer);
+	SK_ASSERT(task_current);
+
+	sk_arch_disable_int();
+	while (!xfer->done) {
+		xfer->task = task_current;
+		sk_task_await();
+		sk_arch_disable_int();
+	}
+	xfer->task = NULL;
+	sk_arch_enable_int();
+}
+
+void sk_spi_transfer(sk_spi_xfer *xfer)
+{
+	sk_spi_submit(xfer);
+	sk_spi_wait(xfer);
+}
+
+#endif /* SKIRT_SPI */
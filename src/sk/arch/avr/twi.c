@@ -0,0 +1,228 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief AVR TWI master, the bus state machine runs in the TWI interrupt.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/twi.h>
+#include <sk/arch.h>
+#include <sk/irq.h>
+
+#ifdef SKIRT_TWI
+
+/* SCL = F_CPU / (16 + 2 * TWBR), prescaler set to 1. */
+#define SK_TWI_TWBR ((F_CPU / SKIRT_TWI_FREQ - 16) / 2)
+
+#if SK_TWI_TWBR > 255 || F_CPU / SKIRT_TWI_FREQ < 16
+#error "SKIRT_TWI_FREQ cannot be reached from F_CPU!"
+#endif
+
+/* TWSR status codes (prescaler bits masked) in master modes. */
+#define SK_TWSR_START 0x08
+#define SK_TWSR_REP_START 0x10
+#define SK_TWSR_MT_SLA_ACK 0x18
+#define SK_TWSR_MT_SLA_NACK 0x20
+#define SK_TWSR_MT_DATA_ACK 0x28
+#define SK_TWSR_MT_DATA_NACK 0x30
+#define SK_TWSR_ARB_LOST 0x38
+#define SK_TWSR_MR_SLA_ACK 0x40
+#define SK_TWSR_MR_SLA_NACK 0x48
+#define SK_TWSR_MR_DATA_ACK 0x50
+#define SK_TWSR_MR_DATA_NACK 0x58
+
+/* Clear TWINT to let the hardware run the next step. */
+#define SK_TWCR_GO ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+
+extern sk_task *volatile task_current;
+
+/* Queued transactions, the head one is on the bus. */
+static sk_twi_xfer *twi_head = NULL;
+static sk_twi_xfer *twi_tail = NULL;
+/* Position in the head transaction. */
+static unsigned char twi_seg;
+static unsigned char twi_pos;
+
+SKIRT_IRQ(TWI_vect, twi_irq)
+
+/* Wake the owner and start the next transaction right after the STOP. */
+static void sk_twi_done(sk_twi_status status, unsigned char twcr)
+{
+	sk_twi_xfer *xfer = twi_head;
+
+	twi_head = xfer->next;
+	if (!twi_head) {
+		twi_tail = NULL;
+	}
+	twi_seg = 0;
+	twi_pos = 0;
+
+	xfer->status = status;
+	sk_task_wake_isr(xfer->task);
+
+	/* With TWSTO and TWSTA both set, a STOP then a START are sent. */
+	TWCR = SK_TWCR_GO | twcr | (twi_head ? (1 << TWSTA) : 0);
+}
+
+static void sk_twi_isr(void *arg)
+{
+	sk_twi_xfer *xfer = twi_head;
+
+	(void)arg;
+	if (!xfer) {
+		TWCR = (1 << TWINT) | (1 << TWEN);
+		return;
+	}
+	const sk_twi_seg *seg = &xfer->segs[twi_seg];
+
+	switch (TWSR & 0xf8) {
+	case SK_TWSR_START:
+	case SK_TWSR_REP_START:
+		TWDR = (unsigned char)(xfer->addr << 1) |
+		       (seg->flags & SK_TWI_READ);
+		TWCR = SK_TWCR_GO;
+		return;
+	case SK_TWSR_MT_SLA_ACK:
+	case SK_TWSR_MT_DATA_ACK:
+		break;
+	case SK_TWSR_MT_DATA_NACK:
+		/* Fine on the last byte, some devices always do it. */
+		if (twi_pos < seg->len) {
+			sk_twi_done(SK_TWI_NACK_DATA, 1 << TWSTO);
+			return;
+		}
+		break;
+	case SK_TWSR_MT_SLA_NACK:
+	case SK_TWSR_MR_SLA_NACK:
+		sk_twi_done(SK_TWI_NACK_ADDR, 1 << TWSTO);
+		return;
+	case SK_TWSR_ARB_LOST:
+		/* The bus belongs to the other master, no STOP. */
+		sk_twi_done(SK_TWI_ARB_LOST, 0);
+		return;
+	case SK_TWSR_MR_DATA_ACK:
+	case SK_TWSR_MR_DATA_NACK:
+		seg->buf[twi_pos++] = TWDR;
+		/* fallthrough */
+	case SK_TWSR_MR_SLA_ACK:
+		if (twi_pos < seg->len) {
+			/* ACK every byte but the last one. */
+			TWCR = SK_TWCR_GO |
+			       (twi_pos + 1 < seg->len ? (1 << TWEA) : 0);
+			return;
+		}
+		break;
+	default:
+		/* Bus error, TWSTO only releases the lines. */
+		sk_twi_done(SK_TWI_BUS_ERROR, 1 << TWSTO);
+		return;
+	}
+
+	if (!(seg->flags & SK_TWI_READ) && twi_pos < seg->len) {
+		TWDR = seg->buf[twi_pos++];
+		TWCR = SK_TWCR_GO;
+		return;
+	}
+
+	if (++twi_seg < xfer->nsegs) {
+		twi_pos = 0;
+		TWCR = SK_TWCR_GO | (1 << TWSTA);
+		return;
+	}
+	sk_twi_done(SK_TWI_OK, 1 << TWSTO);
+}
+
+void sk_twi_init(void)
+{
+	sk_irq_attach_handler(&twi_irq, sk_twi_isr, NULL);
+	TWSR = 0;
+	TWBR = SK_TWI_TWBR;
+	TWCR = (1 << TWEN) | (1 << TWIE);
+}
+
+sk_twi_status sk_twi_transfer(sk_twi_xfer *xfer)
+{
+	SK_ASSERT(xfer);
+	SK_ASSERT(xfer->segs && xfer->nsegs);
+	SK_ASSERT(task_current);
+
+	xfer->status = SK_TWI_PENDING;
+	xfer->task = task_current;
+	xfer->next = NULL;
+
+	sk_arch_disable_int();
+	if (twi_tail) {
+		twi_tail->next = xfer;
+	} else {
+		/* Bus idle, the interrupt takes it from the START. A STOP
+		 * sent by sk_twi_done() may still be on the bus, writing TWCR
+		 * before it is out would turn it into a repeated START. */
+		twi_head = xfer;
+		while (TWCR & (1 << TWSTO))
+			;
+		TWCR = SK_TWCR_GO | (1 << TWSTA);
+	}
+	twi_tail = xfer;
+
+	while (xfer->status == SK_TWI_PENDING) {
+		sk_task_await();
+		sk_arch_disable_int();
+	}
+	sk_arch_enable_int();
+
+	return (sk_twi_status)xfer->status;
+}
+
+sk_twi_status sk_twi_write_read(unsigned char addr, const void *wbuf,
+				unsigned char wlen, void *rbuf,
+				unsigned char rlen)
+{
+	sk_twi_seg segs[2];
+	unsigned char nsegs = 0;
+
+	if (wlen) {
+		/* Write segments are only read from. */
+		segs[nsegs++] = (sk_twi_seg){ (unsigned char *)wbuf, wlen,
+					      SK_TWI_WRITE };
+	}
+	if (rlen) {
+		segs[nsegs++] = (sk_twi_seg){ rbuf, rlen, SK_TWI_READ };
+	}
+
+	sk_twi_xfer xfer = { .segs = segs, .nsegs = nsegs, .addr = addr };
+	return sk_twi_transfer(&xfer);
+}
+
+#endif /* SKIRT_TWI */
@@ -0,0 +1,344 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Host (POSIX) specific code.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/arch.h>
+#include <sk/serial.h>
+#include <sk/latency.h>
+#include <sk/irq.h>
+#include <sk/link.h>
+#include <sk/ipc.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+extern sk_task *volatile task_current;
+extern volatile bool task_resched;
+extern volatile sk_size_t kernel_ticks;
+
+/* Signals blocked when interrupts are disabled. */
+static sigset_t irq_mask;
+/* Handlers registered by SKIRT_IRQ(), installed when the kernel starts. */
+static void (*irq_handlers[NSIG])(int);
+
+static ucontext_t task_contexts[SKIRT_TASK_MAX];
+static sk_task_func task_funcs[SKIRT_TASK_MAX];
+static unsigned char task_stacks[SKIRT_TASK_MAX][SKIRT_POSIX_STACK_SZ]
+	__attribute__((aligned(16)));
+
+/* Host time of the last tick, used to interpolate the timer count. */
+static volatile unsigned long long tick_stamp;
+
+/* Runs before SKIRT_IRQ() constructors. */
+__attribute__((constructor(101))) static void sk_posix_init(void)
+{
+	sigemptyset(&irq_mask);
+	sigaddset(&irq_mask, SIGALRM);
+}
+
+static unsigned long long sk_posix_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL +
+	       (unsigned long long)ts.tv_nsec;
+}
+
+/* Signals are handled on the task stack as soon as it runs again. */
+static void sk_posix_sig_deliver(void)
+{
+#ifdef SKIRT_SIG
+	if (sk_sig_need_frame(task_current)) {
+		sk_sig_run();
+	}
+#endif /* SKIRT_SIG */
+}
+
+/* Resume the elected task if it is not prev, interrupts are disabled. */
+static void sk_posix_switch_from(sk_task *prev)
+{
+	SK_ASSERT(task_current);
+	if (task_current != prev) {
+		swapcontext(&task_contexts[sk_task_id(prev)],
+			    &task_contexts[sk_task_id(task_current)]);
+	}
+	sk_posix_sig_deliver();
+}
+
+static void sk_posix_tick(int sig)
+{
+	int saved_errno = errno;
+	(void)sig;
+
+	sk_task *prev = task_current;
+	tick_stamp = sk_posix_now_ns();
+	kernel_ticks++;
+	SK_CS_ENTER();
+	sk_task_switch();
+	SK_CS_EXIT(SK_CS_TICK);
+	sk_posix_switch_from(prev);
+
+	errno = saved_errno;
+}
+
+/* Every task starts here, returning from a task ends it. */
+static void sk_posix_task_entry(void)
+{
+	sk_posix_sig_deliver();
+	sk_arch_enable_int();
+	task_funcs[sk_task_self()]();
+	sk_task_exit();
+}
+
+void sk_arch_stack_init(sk_task_func func, sk_task *task)
+{
+	sk_tid tid = sk_task_id(task);
+	ucontext_t *ctx = &task_contexts[tid];
+
+	getcontext(ctx);
+	ctx->uc_stack.ss_sp = task_stacks[tid];
+	ctx->uc_stack.ss_size = sizeof task_stacks[tid];
+	ctx->uc_link = NULL;
+	/*
+	 * swapcontext() sets the new mask before switching stacks, an interrupt
+	 * must never be unmasked there: every saved context has interrupts
+	 * disabled and the task entry enables them.
+	 */
+	sigprocmask(SIG_SETMASK, NULL, &ctx->uc_sigmask);
+	for (int sig = 1; sig < NSIG; ++sig) {
+		if (sigismember(&irq_mask, sig) == 1) {
+			sigaddset(&ctx->uc_sigmask, sig);
+		}
+	}
+	makecontext(ctx, sk_posix_task_entry, 0);
+	task_funcs[tid] = func;
+
+	/* Nothing is saved on the task stack. */
+	task->sp = task->stack + task->stack_sz - 1;
+}
+
+void sk_arch_init_preempt(void)
+{
+	/* Like a MCU out of reset, nothing fires before the first task runs. */
+	sigprocmask(SIG_BLOCK, &irq_mask, NULL);
+
+	struct sigaction sa = { 0 };
+	sa.sa_mask = irq_mask;
+	sa.sa_flags = SA_RESTART;
+	for (int sig = 1; sig < NSIG; ++sig) {
+		if (irq_handlers[sig]) {
+			sa.sa_handler = irq_handlers[sig];
+			sigaction(sig, &sa, NULL);
+		}
+	}
+	sa.sa_handler = sk_posix_tick;
+	sigaction(SIGALRM, &sa, NULL);
+
+	tick_stamp = sk_posix_now_ns();
+	struct itimerval timer = { 0 };
+	timer.it_interval.tv_sec = SKIRT_POSIX_TICK_US / 1000000;
+	timer.it_interval.tv_usec = SKIRT_POSIX_TICK_US % 1000000;
+	timer.it_value = timer.it_interval;
+	setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+void sk_arch_first_yield(sk_task *task)
+{
+	setcontext(&task_contexts[sk_task_id(task)]);
+	SK_VERIFY_NOT_REACHED();
+}
+
+void sk_arch_yield(void)
+{
+	sk_task *prev = task_current;
+	SK_CS_ENTER();
+	sk_task_schedule();
+	SK_CS_EXIT(SK_CS_YIELD);
+	sk_posix_switch_from(prev);
+	sk_arch_enable_int();
+}
+
+sk_size_t sk_arch_timer_now(void)
+{
+	unsigned long long elapsed = sk_posix_now_ns() - tick_stamp;
+	unsigned long long count = elapsed * SK_ARCH_TIMER_PERIOD /
+				   (SKIRT_POSIX_TICK_US * 1000ULL);
+	return count < SK_ARCH_TIMER_PERIOD ? (sk_size_t)count :
+					      SK_ARCH_TIMER_PERIOD - 1;
+}
+
+bool sk_arch_timer_wrapped(void)
+{
+	sigset_t pending;
+	sigpending(&pending);
+	return sigismember(&pending, SIGALRM) == 1;
+}
+
+void sk_arch_irq_install(int sig, void (*handler)(int))
+{
+	SK_ASSERT(sig > 0 && sig < NSIG && sig != SIGALRM);
+	sigaddset(&irq_mask, sig);
+	irq_handlers[sig] = handler;
+}
+
+void sk_arch_irq_exit(void)
+{
+	if (task_current && task_resched) {
+		sk_task *prev = task_current;
+		sk_task_schedule();
+		sk_posix_switch_from(prev);
+	}
+}
+
+void sk_arch_idle(void)
+{
+#ifdef SKIRT_POSIX_SKIP_IDLE
+	/* Nothing to do until the next tick, jump to it. */
+	raise(SIGALRM);
+#else
+	pause();
+#endif /* SKIRT_POSIX_SKIP_IDLE */
+}
+
+void sk_arch_enable_int(void)
+{
+	sigprocmask(SIG_UNBLOCK, &irq_mask, NULL);
+}
+
+void sk_arch_disable_int(void)
+{
+	sigprocmask(SIG_BLOCK, &irq_mask, NULL);
+}
+
+sk_int_state_t sk_arch_save_int(void)
+{
+	sigset_t old;
+	sigprocmask(SIG_BLOCK, &irq_mask, &old);
+	return sigismember(&old, SIGALRM) != 1;
+}
+
+void sk_arch_restore_int(sk_int_state_t state)
+{
+	if (state) {
+		sk_arch_enable_int();
+	}
+}
+
+void sk_arch_panic(const char *msg)
+{
+	fputs("\n-- KERNEL PANIC --\n", stderr);
+	fputs(msg, stderr);
+	abort();
+}
+
+void sk_arch_serial_init(void)
+{
+}
+
+void sk_arch_serial_putc(char c)
+{
+	/* Not stdio, a task may be preempted in the middle of a call. */
+	while (write(STDOUT_FILENO, &c, 1) < 0 && errno == EINTR)
+		;
+}
+
+#ifdef SKIRT_LINK
+/* stdin raises SIGIO when bytes arrive, like a UART receive interrupt. */
+SKIRT_IRQ(SIGIO, link_rx_irq)
+
+static void sk_posix_link_rx(void *arg)
+{
+	unsigned char buf[64];
+	ssize_t len;
+
+	(void)arg;
+	while ((len = read(STDIN_FILENO, buf, sizeof buf)) > 0) {
+		for (ssize_t i = 0; i < len; ++i) {
+			sk_link_rx_isr(buf[i]);
+		}
+	}
+}
+
+static void sk_posix_write(const unsigned char *buf, size_t len)
+{
+	while (len) {
+		ssize_t sent = write(STDOUT_FILENO, buf, len);
+		if (sent < 0) {
+			if (errno != EINTR) {
+				return;
+			}
+			continue;
+		}
+		buf += sent;
+		len -= (size_t)sent;
+	}
+}
+
+void sk_arch_link_init(void)
+{
+	sk_irq_attach_handler(&link_rx_irq, sk_posix_link_rx, NULL);
+	/* stdin is shared with the shell, it is left non-blocking on exit. */
+	fcntl(STDIN_FILENO, F_SETOWN, getpid());
+	fcntl(STDIN_FILENO, F_SETFL,
+	      fcntl(STDIN_FILENO, F_GETFL) | O_ASYNC | O_NONBLOCK);
+}
+
+void sk_arch_link_tx_start(void)
+{
+	/* An infinitely fast UART, a write() per batch instead of per byte. */
+	unsigned char buf[64];
+	size_t len = 0;
+	int c;
+
+	while ((c = sk_link_tx_isr()) >= 0) {
+		buf[len++] = (unsigned char)c;
+		if (len == sizeof buf) {
+			sk_posix_write(buf, len);
+			len = 0;
+		}
+	}
+	sk_posix_write(buf, len);
+}
+#endif /* SKIRT_LINK */
@@ -0,0 +1,108 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Deferred procedure calls, drained by a kernel worker task.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/dpc.h>
+#include <sk/arch.h>
+
+#ifdef SKIRT_DPC
+
+#define SK_DPC_MASK (SKIRT_DPC_MAX - 1)
+
+static sk_stack_t dpc_stack[SKIRT_DPC_STACK_SZ];
+static sk_task *dpc_worker = NULL;
+
+static sk_dpc dpc_queue[SKIRT_DPC_MAX];
+/* Single bytes so they can be read without disabling interrupts. */
+static volatile unsigned char dpc_head = 0;
+static volatile unsigned char dpc_tail = 0;
+
+/* Runs every queued call, new ones posted meanwhile are left for the next batch. */
+static SK_NORETURN void sk_dpc_worker_task(void)
+{
+	for (;;) {
+		sk_arch_disable_int();
+		unsigned char end = dpc_tail;
+		if (end == dpc_head) {
+			sk_task_await();
+			continue;
+		}
+		sk_arch_enable_int();
+
+		unsigned char i = dpc_head;
+		while (i != end) {
+			dpc_queue[i].func(dpc_queue[i].arg);
+			i = (i + 1) & SK_DPC_MASK;
+			/* Release the slot only once the call is done. */
+			dpc_head = i;
+		}
+	}
+	SK_VERIFY_NOT_REACHED();
+}
+
+void sk_dpc_init(void)
+{
+	dpc_worker = sk_task_create_static(sk_dpc_worker_task, SKIRT_DPC_PRIO,
+					   dpc_stack, sizeof dpc_stack);
+}
+
+bool sk_dpc_post(sk_dpc_func func, void *arg)
+{
+	SK_ASSERT(func);
+
+	sk_int_state_t state = sk_arch_save_int();
+	unsigned char next = (dpc_tail + 1) & SK_DPC_MASK;
+	if (next == dpc_head) {
+		sk_arch_restore_int(state);
+		return false;
+	}
+
+	dpc_queue[dpc_tail].func = func;
+	dpc_queue[dpc_tail].arg = arg;
+	dpc_tail = next;
+
+	if (dpc_worker) {
+		sk_task_wake_isr(dpc_worker);
+	}
+	sk_arch_restore_int(state);
+
+	return true;
+}
+
+#endif /* SKIRT_DPC */
@@ -39,12 +39,16 @@ knowledge of the CeCILL license and that you accept its terms.
  */
 
 #include <sk/ipc.h>
+#include <sk/pt.h>
+#include <sk/trace.h>
+#include <sk/latency.h>
 
 /* TODO: Find a prettier way to retrieve calling task. */
 extern sk_task *task_current;
 
 #ifdef SKIRT_ALLOC_STATIC
 
+#ifdef SKIRT_SEM
 #ifndef SKIRT_SEM_MAX
 #define SKIRT_SEM_MAX SKIRT_TASK_MAX
 #endif /* SKIRT_SEM_MAX */
@@ -53,7 +57,7 @@ static sk_sem sem_pool[SKIRT_SEM_MAX] = { 0 };
 
 static inline sk_sem *sk_sem_alloc(int initial_value)
 {
-	for (sk_size_t i = 0; i < SKIRT_TASK_MAX; ++i) {
+	for (sk_size_t i = 0; i < SKIRT_SEM_MAX; ++i) {
 		if (sem_pool[i].flag == 0) {
 			sem_pool[i].counter = initial_value;
 			sem_pool[i].flag = 1;
@@ -67,13 +71,15 @@ static inline sk_sem *sk_sem_alloc(int initial_value)
 static inline void sk_sem_free(sk_sem *sem)
 {
 	SK_ASSERT(sem);
-	if (sem < sem_pool || sem > &sem_pool[SKIRT_TASK_MAX - 1]) {
+	if (sem < sem_pool || sem > &sem_pool[SKIRT_SEM_MAX - 1]) {
 		SK_PANIC("Provided sem is not from the static pool!\n\r");
 	}
 	sem->counter = 0;
 	sem->flag = 0;
 }
+#endif /* SKIRT_SEM */
 
+#ifdef SKIRT_MAIL
 #ifndef SKIRT_MAIL_MAX
 #define SKIRT_MAIL_MAX SKIRT_TASK_MAX
 #endif /* SKIRT_MAIL_MAX */
@@ -82,7 +88,7 @@ static sk_mail mail_pool[SKIRT_MAIL_MAX] = { 0 };
 
 static inline sk_mail *sk_mail_alloc(const void *msg)
 {
-	for (sk_size_t i = 0; i < SKIRT_TASK_MAX; ++i) {
+	for (sk_size_t i = 0; i < SKIRT_MAIL_MAX; ++i) {
 		if (mail_pool[i].task == NULL) {
 			mail_pool[i].next = NULL;
 			mail_pool[i].msg = msg;
@@ -96,18 +102,20 @@ static inline sk_mail *sk_mail_alloc(const void *msg)
 static inline void sk_mail_free(sk_mail *mail)
 {
 	SK_ASSERT(mail);
-	if (mail < mail_pool || mail > &mail_pool[SKIRT_TASK_MAX - 1]) {
+	if (mail < mail_pool || mail > &mail_pool[SKIRT_MAIL_MAX - 1]) {
 		SK_PANIC("Provided mail is not from the static pool!\n\r");
 	}
 	mail->msg = NULL;
 	mail->task = NULL;
 	mail->next = NULL;
 }
+#endif /* SKIRT_MAIL */
 
 #else
 #error "FIXME: Only SKIRT_ALLOC_STATIC is supported!"
 #endif /* SKIRT_ALLOC_STATIC */
 
+#ifdef SKIRT_SEM
 sk_sem *sk_sem_create(int initial_value)
 {
 	sk_arch_disable_int();
@@ -137,7 +145,14 @@ void sk_sem_release(sk_sem *sem)
 		return;
 	}
 	sk_arch_disable_int();
+	SK_CS_ENTER();
 	sem->counter++;
+	SK_TRACE(SK_TRACE_SEM_RELEASE, (unsigned char)(sem - sem_pool));
+#ifdef SKIRT_PT
+	/* A protothread may wait for it. */
+	sk_pt_wake();
+#endif /* SKIRT_PT */
+	SK_CS_EXIT(SK_CS_SEM_RELEASE);
 	sk_arch_enable_int();
 }
 
@@ -147,12 +162,19 @@ void sk_sem_acquire(sk_sem *sem)
 		return;
 	}
 	sk_arch_disable_int();
+	SK_CS_ENTER();
 
 	while (sem->counter == 0) {
-		sk_arch_disable_int();
+		SK_TRACE(SK_TRACE_SEM_BLOCK, (unsigned char)(sem - sem_pool));
+		SK_CS_EXIT(SK_CS_SEM_ACQUIRE);
 		sk_arch_yield();
+		/* Counter must be checked again with interrupts disabled. */
+		sk_arch_disable_int();
+		SK_CS_ENTER();
 	}
 	sem->counter--;
+	SK_TRACE(SK_TRACE_SEM_ACQUIRE, (unsigned char)(sem - sem_pool));
+	SK_CS_EXIT(SK_CS_SEM_ACQUIRE);
 	sk_arch_enable_int();
 }
 
@@ -167,14 +189,106 @@ bool sk_sem_try_acquire(sk_sem *sem)
 	sk_arch_enable_int();
 	return true;
 }
+#endif /* SKIRT_SEM */
+
+#ifdef SKIRT_SIG
+extern volatile bool task_resched;
+
+static sk_sig_handler *sig_handlers[SK_SIG_MAX];
+
+void sk_sig_register(int sig, sk_sig_handler handler)
+{
+	SK_ASSERT(sig >= 0 && sig < SK_SIG_MAX);
+
+	sk_arch_disable_int();
+	sig_handlers[sig] = handler;
+	sk_arch_enable_int();
+}
+
+void sk_sig_send(sk_task *task, int sig)
+{
+	SK_ASSERT(task);
+	SK_ASSERT(sig >= 0 && sig < SK_SIG_MAX);
+
+	sk_int_state_t state = sk_arch_save_int();
+	task->sig_pending |= (unsigned char)(1 << sig);
+	if (task == task_current) {
+		if (!sk_arch_int_enabled(state)) {
+			/* Interrupted task, run the handler when leaving a
+			 * SKIRT_IRQ(). */
+			task_resched = true;
+		} else if (task->sig_pending & ~task->sig_blocked) {
+			/* Signalled by itself, run handlers right away. */
+			sk_arch_yield();
+			return;
+		}
+	}
+	sk_arch_restore_int(state);
+}
+
+unsigned char sk_sig_block(unsigned char mask)
+{
+	sk_arch_disable_int();
+	SK_ASSERT(task_current);
+	unsigned char old = task_current->sig_blocked;
+	task_current->sig_blocked = mask;
+	if (task_current->sig_pending & ~mask) {
+		/* Run unblocked handlers right away. */
+		sk_arch_yield();
+		return old;
+	}
+	sk_arch_enable_int();
+	return old;
+}
+
+bool sk_sig_need_frame(sk_task *task)
+{
+	if (task->sig_frame || !(task->sig_pending & ~task->sig_blocked)) {
+		return false;
+	}
+	task->sig_frame = true;
+	return true;
+}
 
+void sk_sig_run(void)
+{
+	sk_task *task = task_current;
+	unsigned char blocked = task->sig_blocked;
+
+	task->sig_frame = false;
+	for (;;) {
+		unsigned char sigs = task->sig_pending & ~blocked;
+		if (!sigs) {
+			break;
+		}
+		task->sig_pending &= ~sigs;
+		/* Signals sent meanwhile wait for the current batch. */
+		task->sig_blocked = 0xff;
+		sk_arch_enable_int();
+
+		for (unsigned char sig = 0; sig < SK_SIG_MAX; ++sig) {
+			sk_sig_handler *handler = sig_handlers[sig];
+			if ((sigs & (1 << sig)) && handler) {
+				handler(sig);
+			}
+		}
+
+		sk_arch_disable_int();
+		task->sig_blocked = blocked;
+	}
+}
+#endif /* SKIRT_SIG */
+
+#ifdef SKIRT_MAIL
 bool sk_mail_send_to(sk_task *task, const void *msg)
 {
 	sk_arch_disable_int();
+	SK_CS_ENTER();
 	SK_ASSERT(task);
 
 	sk_mail *mail = sk_mail_alloc(msg);
 	if (!mail) {
+		SK_CS_EXIT(SK_CS_MAIL_SEND);
 		sk_arch_enable_int();
 		return false;
 	}
@@ -190,9 +304,11 @@ bool sk_mail_send_to(sk_task *task, const void *msg)
 		}
 		tmp->next = mail;
 	}
+	SK_TRACE(SK_TRACE_MAIL_SEND, sk_task_id(task));
+	SK_CS_EXIT(SK_CS_MAIL_SEND);
+	sk_arch_enable_int();
 
 	return true;
-	sk_arch_enable_int();
 }
 
 /* O0 "optimization" forced to prevent a read on task_current after enabling
@@ -208,7 +324,9 @@ SK_NOOPTI bool sk_mail_available(void)
 const void *sk_mail_pickup(void)
 {
 	sk_arch_disable_int();
+	SK_CS_ENTER();
 	if (!task_current->mailbox) {
+		SK_CS_EXIT(SK_CS_MAIL_PICKUP);
 		sk_arch_enable_int();
 		return NULL;
 	}
@@ -217,7 +335,201 @@ const void *sk_mail_pickup(void)
 	sk_mail *tmp = task_current->mailbox;
 	task_current->mailbox = task_current->mailbox->next;
 	sk_mail_free(tmp);
+	SK_TRACE(SK_TRACE_MAIL_PICKUP, sk_task_id(task_current));
+	SK_CS_EXIT(SK_CS_MAIL_PICKUP);
+	sk_arch_enable_int();
+
+	return msg;
+}
+#endif /* SKIRT_MAIL */
+
+#ifdef SKIRT_MSG
+/* Run a server at the priority of its most urgent client, a server blocked
+ * on another one passes it on. Interrupts must be disabled. */
+static void sk_msg_inherit(sk_task *server)
+{
+	while (server) {
+		signed char priority = server->base_priority;
+		for (sk_msg *msg = server->msg_queue; msg; msg = msg->next) {
+			if (msg->sender->priority > priority) {
+				priority = msg->sender->priority;
+			}
+		}
+		if (priority == server->priority) {
+			return;
+		}
+		server->priority = priority;
+		server = server->msg_server;
+	}
+}
+
+sk_size_t sk_msg_send(sk_task *server, const void *data, sk_size_t len,
+		      void *reply, sk_size_t reply_sz)
+{
+	/* Lives on the client stack, the client is blocked until the reply. */
+	sk_msg msg = { .data = data,
+		       .len = len,
+		       .reply = reply,
+		       .reply_sz = reply_sz };
+
+	sk_arch_disable_int();
+	SK_CS_ENTER();
+	SK_ASSERT(server);
+	SK_ASSERT(server != task_current);
+	msg.sender = task_current;
+
+	/* Most urgent clients first, in sending order among equals. */
+	sk_msg **link = &server->msg_queue;
+	while (*link && (*link)->sender->priority >= task_current->priority) {
+		link = &(*link)->next;
+	}
+	msg.next = *link;
+	*link = &msg;
+	task_current->msg_server = server;
+	sk_msg_inherit(server);
+	SK_TRACE(SK_TRACE_MSG_SEND, sk_task_id(server));
+
+	if (server->msg_receiving) {
+		server->msg_receiving = false;
+		sk_task_wake_isr(server);
+	}
+
+	while (!msg.done) {
+		task_current->state = WAITING;
+		SK_CS_EXIT(SK_CS_MSG_SEND);
+		sk_arch_yield();
+		sk_arch_disable_int();
+		SK_CS_ENTER();
+	}
+	task_current->msg_server = NULL;
+	SK_CS_EXIT(SK_CS_MSG_SEND);
+	sk_arch_enable_int();
+
+	return msg.reply_len;
+}
+
+sk_msg *sk_msg_receive(void)
+{
+	sk_msg *msg;
+
+	sk_arch_disable_int();
+	SK_CS_ENTER();
+	SK_ASSERT(task_current);
+	for (;;) {
+		msg = task_current->msg_queue;
+		while (msg && msg->received) {
+			msg = msg->next;
+		}
+		if (msg) {
+			break;
+		}
+		task_current->msg_receiving = true;
+		task_current->state = WAITING;
+		SK_CS_EXIT(SK_CS_MSG_RECEIVE);
+		sk_arch_yield();
+		sk_arch_disable_int();
+		SK_CS_ENTER();
+	}
+	task_current->msg_receiving = false;
+	msg->received = true;
+	SK_TRACE(SK_TRACE_MSG_RECEIVE, sk_task_id(msg->sender));
+	SK_CS_EXIT(SK_CS_MSG_RECEIVE);
+	sk_arch_enable_int();
+
+	return msg;
+}
+
+void sk_msg_reply(sk_msg *msg, sk_size_t len)
+{
+	SK_ASSERT(msg);
+	SK_ASSERT(len <= msg->reply_sz);
+
+	sk_arch_disable_int();
+	SK_CS_ENTER();
+	SK_ASSERT(msg->received);
+	sk_msg **link = &task_current->msg_queue;
+	while (*link != msg) {
+		SK_ASSERT(*link);
+		link = &(*link)->next;
+	}
+	*link = msg->next;
+
+	/* msg is on the client stack, it must not be used once it runs. */
+	sk_task *sender = msg->sender;
+	msg->reply_len = len;
+	msg->done = true;
+	SK_TRACE(SK_TRACE_MSG_REPLY, sk_task_id(sender));
+	sk_msg_inherit(task_current);
+	sk_task_wake_isr(sender);
+
+#ifdef SKIRT_HARD_PRIO
+	/* Back to its own priority, the server may have to give way. */
+	if (sender->priority > task_current->priority) {
+		SK_CS_EXIT(SK_CS_MSG_REPLY);
+		sk_arch_yield();
+		return;
+	}
+#endif /* SKIRT_HARD_PRIO */
+	SK_CS_EXIT(SK_CS_MSG_REPLY);
+	sk_arch_enable_int();
+}
+#endif /* SKIRT_MSG */
+
+#ifdef SKIRT_PT
+bool sk_pt_mail_send(sk_pt *pt, const void *msg)
+{
+	sk_arch_disable_int();
+	SK_ASSERT(pt);
+
+	/* Exited protothread. */
+	if (!pt->func) {
+		sk_arch_enable_int();
+		return false;
+	}
+
+	sk_mail *mail = sk_mail_alloc(msg);
+	if (!mail) {
+		sk_arch_enable_int();
+		return false;
+	}
+
+	/* Protothread mails belong to the runner task. */
+	mail->task = pt_runner;
+
+	if (!pt->mailbox) {
+		pt->mailbox = mail;
+	} else {
+		sk_mail *tmp = pt->mailbox;
+		while (tmp->next) {
+			tmp = tmp->next;
+		}
+		tmp->next = mail;
+	}
+	sk_pt_wake();
+
+	sk_arch_enable_int();
+	return true;
+}
+
+bool sk_pt_mail_available(sk_pt *pt)
+{
+	return pt->mailbox != NULL;
+}
+
+const void *sk_pt_mail_pickup(sk_pt *pt)
+{
+	sk_arch_disable_int();
+	if (!pt->mailbox) {
+		sk_arch_enable_int();
+		return NULL;
+	}
+
+	const void *msg = pt->mailbox->msg;
+	sk_mail *tmp = pt->mailbox;
+	pt->mailbox = pt->mailbox->next;
+	sk_mail_free(tmp);
 	sk_arch_enable_int();
 
 	return msg;
 }
+#endif /* SKIRT_PT */
@@ -0,0 +1,113 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Hardware interrupts registration for tasks.
+ * @note See sk/arch/<arch>.c for the vector wrappers.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/irq.h>
+#include <sk/trace.h>
+
+void sk_irq_dispatch(sk_irq *irq)
+{
+	/* Low byte of the descriptor address is enough to tell IRQs apart. */
+	SK_TRACE(SK_TRACE_ISR_ENTER, (unsigned char)(sk_size_t)irq);
+
+	if (irq->pending < 0xff) {
+		irq->pending++;
+	}
+
+	if (irq->handler) {
+		irq->handler(irq->arg);
+	}
+
+	if (irq->task && irq->pending >= irq->count) {
+		sk_task_wake_isr(irq->task);
+	}
+
+	SK_TRACE(SK_TRACE_ISR_EXIT, (unsigned char)(sk_size_t)irq);
+}
+
+void sk_irq_attach(sk_irq *irq, sk_task *task, unsigned char count)
+{
+	SK_ASSERT(irq);
+	SK_ASSERT(task);
+
+	sk_int_state_t state = sk_arch_save_int();
+	irq->task = task;
+	irq->count = count ? count : 1;
+	irq->pending = 0;
+	sk_arch_restore_int(state);
+}
+
+void sk_irq_attach_handler(sk_irq *irq, sk_irq_handler handler, void *arg)
+{
+	SK_ASSERT(irq);
+
+	sk_int_state_t state = sk_arch_save_int();
+	irq->handler = handler;
+	irq->arg = arg;
+	sk_arch_restore_int(state);
+}
+
+void sk_irq_detach(sk_irq *irq)
+{
+	SK_ASSERT(irq);
+
+	sk_int_state_t state = sk_arch_save_int();
+	irq->handler = NULL;
+	irq->arg = NULL;
+	irq->task = NULL;
+	irq->pending = 0;
+	sk_arch_restore_int(state);
+}
+
+unsigned char sk_irq_wait(sk_irq *irq)
+{
+	SK_ASSERT(irq);
+
+	sk_arch_disable_int();
+	while (irq->pending < irq->count) {
+		sk_task_await();
+		sk_arch_disable_int();
+	}
+	unsigned char received = irq->pending;
+	irq->pending = 0;
+	sk_arch_enable_int();
+
+	return received;
+}
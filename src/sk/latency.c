@@ -0,0 +1,182 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Interrupt-disabled time and wake-up latency measurements.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/latency.h>
+#include <sk/task.h>
+#include <sk/arch.h>
+#include <sk/serial.h>
+
+#ifdef SKIRT_LATENCY
+
+extern volatile sk_size_t kernel_ticks;
+
+static const char cs_name0[] SK_PROGMEM = "tick";
+static const char cs_name1[] SK_PROGMEM = "yield";
+static const char cs_name2[] SK_PROGMEM = "sem_acquire";
+static const char cs_name3[] SK_PROGMEM = "sem_release";
+static const char cs_name4[] SK_PROGMEM = "mail_send";
+static const char cs_name5[] SK_PROGMEM = "mail_pickup";
+static const char cs_name6[] SK_PROGMEM = "msg_send";
+static const char cs_name7[] SK_PROGMEM = "msg_receive";
+static const char cs_name8[] SK_PROGMEM = "msg_reply";
+
+static const char *const cs_names[SK_CS_SITES] SK_PROGMEM = {
+	cs_name0, cs_name1, cs_name2, cs_name3, cs_name4,
+	cs_name5, cs_name6, cs_name7, cs_name8,
+};
+
+static sk_latency cs_stats[SK_CS_SITES];
+static unsigned short cs_start;
+
+unsigned short sk_latency_now(void)
+{
+	sk_size_t count = sk_arch_timer_now();
+	sk_size_t ticks = kernel_ticks;
+
+	/* The timer wrapped but its interrupt is still pending. */
+	if (sk_arch_timer_wrapped() && count < SK_ARCH_TIMER_PERIOD / 2) {
+		ticks++;
+	}
+
+	return (unsigned short)(ticks * SK_ARCH_TIMER_PERIOD + count);
+}
+
+void sk_latency_add(sk_latency *lat, unsigned short counts)
+{
+	if (!lat->count || counts < lat->min) {
+		lat->min = counts;
+	}
+	if (counts > lat->max) {
+		lat->max = counts;
+	}
+	if (lat->count < 0xffff) {
+		lat->count++;
+	}
+
+	unsigned char bucket = 0;
+	while (counts && bucket < SKIRT_LATENCY_BUCKETS - 1) {
+		counts >>= 1;
+		bucket++;
+	}
+	if (lat->hist[bucket] < 0xffff) {
+		lat->hist[bucket]++;
+	}
+}
+
+void sk_latency_cs_enter(void)
+{
+	cs_start = sk_latency_now();
+}
+
+void sk_latency_cs_exit(sk_cs_site site)
+{
+	sk_latency_add(&cs_stats[site], sk_latency_now() - cs_start);
+}
+
+bool sk_latency_cs_get(sk_cs_site site, sk_latency *lat)
+{
+	SK_ASSERT(lat);
+	if (site >= SK_CS_SITES) {
+		return false;
+	}
+
+	sk_arch_disable_int();
+	*lat = cs_stats[site];
+	sk_arch_enable_int();
+	return true;
+}
+
+void sk_latency_reset(void)
+{
+	sk_arch_disable_int();
+	for (unsigned char i = 0; i < SK_CS_SITES; ++i) {
+		cs_stats[i] = (sk_latency){ 0 };
+	}
+	sk_arch_enable_int();
+
+	for (sk_tid tid = 0; tid < SKIRT_TASK_MAX; ++tid) {
+		sk_task *task = sk_task_from_id(tid);
+		if (task) {
+			sk_task_latency_reset(task);
+		}
+	}
+}
+
+static void sk_latency_print(const sk_latency *lat)
+{
+	sk_serial_putc('\t');
+	sk_serial_print_uint(lat->count);
+	sk_serial_putc('\t');
+	sk_serial_print_uint(sk_arch_timer_to_us(lat->min));
+	sk_serial_putc('\t');
+	sk_serial_print_uint(sk_arch_timer_to_us(lat->max));
+	for (unsigned char i = 0; i < SKIRT_LATENCY_BUCKETS; ++i) {
+		sk_serial_putc(i ? ' ' : '\t');
+		sk_serial_print_uint(lat->hist[i]);
+	}
+	sk_serial_print_P(SK_PSTR("\n\r"));
+}
+
+void sk_latency_report(void)
+{
+	sk_latency lat;
+
+	sk_serial_print_P(
+		SK_PSTR("Site\tCount\tMin(us)\tMax(us)\tHistogram\n\r"));
+	for (unsigned char i = 0; i < SK_CS_SITES; ++i) {
+		sk_latency_cs_get(i, &lat);
+		sk_serial_print_P(sk_arch_pgm_read_ptr(&cs_names[i]));
+		sk_latency_print(&lat);
+	}
+
+	sk_serial_print_P(
+		SK_PSTR("Task\tCount\tMin(us)\tMax(us)\tHistogram\n\r"));
+	for (sk_tid tid = 0; tid < SKIRT_TASK_MAX; ++tid) {
+		sk_task *task = sk_task_from_id(tid);
+		if (!task) {
+			continue;
+		}
+		sk_task_latency_get(task, &lat);
+		sk_serial_print_uint(tid);
+		sk_latency_print(&lat);
+	}
+}
+
+#endif /* SKIRT_LATENCY */
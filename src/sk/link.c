@@ -0,0 +1,354 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+/**
+ * @brief Framed binary link, COBS coding done by the serial interrupts.
+ * @note See sk/arch/<arch>.c for the interrupt glue.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/link.h>
+#include <sk/task.h>
+
+#ifdef SKIRT_LINK
+
+#define SK_LINK_TX_MASK (SKIRT_LINK_TX_SZ - 1)
+
+/* Channel, payload and CRC. */
+#define SK_LINK_FRAME_MAX (1 + SKIRT_LINK_MTU + 2)
+
+/* Bytes per task in a SK_LINK_STATS frame. */
+#define SK_LINK_STAT_SZ 6
+
+_Static_assert(SKIRT_LINK_MTU >= SK_LINK_STAT_SZ,
+	       "SKIRT_LINK_MTU cannot hold a task statistics record!");
+
+extern sk_task *volatile task_current;
+
+/* Queued frames, each is its length (channel included), channel, payload. */
+static unsigned char tx_buf[SKIRT_LINK_TX_SZ];
+static volatile unsigned char tx_head = 0;
+/* Start of the frame being sent, released once its delimiter is out. */
+static volatile unsigned char tx_tail = 0;
+
+/* Encoder state, only used by the TX interrupt. */
+/* Channel and payload length of the frame being sent, 0 when idle. */
+static unsigned char tx_len = 0;
+/* Next frame byte to send, CRC bytes come after tx_len. */
+static unsigned char tx_pos;
+/* Bytes left in the current COBS group. */
+static unsigned char tx_group;
+/* The current group ends on a zero, replaced by the next code byte. */
+static bool tx_zero;
+static unsigned short tx_crc;
+
+/* Received frames, rx_head is the one being filled. */
+static unsigned char rx_buf[SKIRT_LINK_RX_FRAMES][SK_LINK_FRAME_MAX];
+static unsigned char rx_payload_len[SKIRT_LINK_RX_FRAMES];
+static volatile unsigned char rx_head = 0;
+static volatile unsigned char rx_tail = 0;
+static volatile unsigned char rx_errors = 0;
+static sk_task *volatile rx_task = NULL;
+
+/* Decoder state, only used by the RX interrupt. */
+static unsigned char rx_len = 0;
+/* Bytes left in the current COBS group. */
+static unsigned char rx_group = 0;
+/* A zero is owed before the next group. */
+static bool rx_zero = false;
+/* Frame is bad, wait for the next delimiter. */
+static bool rx_skip = false;
+static unsigned short rx_crc = SK_LINK_CRC_INIT;
+
+/* CRC-16/CCITT (polynomial 0x1021) one byte at a time, without a table. */
+static unsigned short sk_link_crc(unsigned short crc, unsigned char byte)
+{
+	unsigned char x = (unsigned char)(crc >> 8) ^ byte;
+	x ^= x >> 4;
+	return (unsigned short)((crc << 8) ^ ((unsigned short)x << 12) ^
+				((unsigned short)x << 5) ^ x);
+}
+
+static unsigned char sk_link_tx_byte(unsigned char pos)
+{
+	if (pos < tx_len) {
+		return tx_buf[(tx_tail + 1 + pos) & SK_LINK_TX_MASK];
+	}
+	return pos == tx_len ? (unsigned char)(tx_crc >> 8) :
+			       (unsigned char)tx_crc;
+}
+
+/*
+ * Look ahead for the end of the group starting at tx_pos. Frame bytes go
+ * through the CRC exactly once, here, so it is complete by the time the scan
+ * reaches the CRC bytes. Frames are shorter than 254 bytes so a group always
+ * ends on a zero or at the end of the frame.
+ */
+static unsigned char sk_link_tx_code(void)
+{
+	unsigned char end = tx_len + 2;
+	unsigned char pos = tx_pos;
+
+	while (pos < end) {
+		unsigned char byte = sk_link_tx_byte(pos);
+		if (pos < tx_len) {
+			tx_crc = sk_link_crc(tx_crc, byte);
+		}
+		if (!byte) {
+			break;
+		}
+		pos++;
+	}
+
+	tx_group = pos - tx_pos;
+	tx_zero = pos < end;
+	return tx_group + 1;
+}
+
+int sk_link_tx_isr(void)
+{
+	if (!tx_len) {
+		if (tx_tail == tx_head) {
+			return -1;
+		}
+		tx_len = tx_buf[tx_tail];
+		tx_pos = 0;
+		tx_crc = SK_LINK_CRC_INIT;
+	} else if (tx_group) {
+		tx_group--;
+		return sk_link_tx_byte(tx_pos++);
+	} else if (tx_zero) {
+		/* The code byte stands for it. */
+		tx_pos++;
+	} else {
+		tx_tail = (tx_tail + 1 + tx_len) & SK_LINK_TX_MASK;
+		tx_len = 0;
+		return 0;
+	}
+
+	return sk_link_tx_code();
+}
+
+static void sk_link_rx_push(unsigned char byte)
+{
+	if (rx_len == SK_LINK_FRAME_MAX) {
+		rx_skip = true;
+		return;
+	}
+	rx_buf[rx_head][rx_len++] = byte;
+	rx_crc = sk_link_crc(rx_crc, byte);
+}
+
+static void sk_link_rx_error(void)
+{
+	if (rx_errors < 0xff) {
+		rx_errors++;
+	}
+}
+
+static void sk_link_rx_deliver(void)
+{
+	unsigned char next = rx_head + 1;
+	if (next == SKIRT_LINK_RX_FRAMES) {
+		next = 0;
+	}
+	if (next == rx_tail) {
+		/* The task is too slow, drop the newest frame. */
+		sk_link_rx_error();
+		return;
+	}
+
+	rx_payload_len[rx_head] = rx_len - 3;
+	rx_head = next;
+	if (rx_task) {
+		sk_task_wake_isr(rx_task);
+	}
+}
+
+void sk_link_rx_isr(unsigned char byte)
+{
+	if (!byte) {
+		/* A data and CRC residue of 0 is a good frame, empty ones are
+		 * only padding. */
+		if (!rx_skip && !rx_group && rx_len >= 3 && !rx_crc) {
+			sk_link_rx_deliver();
+		} else if (rx_len || rx_skip) {
+			sk_link_rx_error();
+		}
+		rx_len = 0;
+		rx_group = 0;
+		rx_zero = false;
+		rx_skip = false;
+		rx_crc = SK_LINK_CRC_INIT;
+		return;
+	}
+
+	if (rx_skip) {
+		return;
+	}
+	if (rx_group) {
+		rx_group--;
+		sk_link_rx_push(byte);
+		return;
+	}
+
+	/* Code byte, the zero owed by the previous group is only known not to
+	 * be the end of the frame now. */
+	if (rx_zero) {
+		sk_link_rx_push(0);
+	}
+	rx_group = byte - 1;
+	rx_zero = byte != 0xff;
+}
+
+void sk_link_init(void)
+{
+	sk_arch_link_init();
+}
+
+bool sk_link_send(unsigned char channel, const void *data, unsigned char len)
+{
+	SK_ASSERT(data || !len);
+	SK_ASSERT(len <= SKIRT_LINK_MTU);
+
+	const unsigned char *bytes = data;
+
+	sk_int_state_t state = sk_arch_save_int();
+	unsigned char used = (tx_head - tx_tail) & SK_LINK_TX_MASK;
+	/* One byte is always left empty to tell full from empty. */
+	if (len + 2 > SKIRT_LINK_TX_SZ - 1 - used) {
+		sk_arch_restore_int(state);
+		return false;
+	}
+
+	unsigned char head = tx_head;
+	tx_buf[head] = len + 1;
+	head = (head + 1) & SK_LINK_TX_MASK;
+	tx_buf[head] = channel;
+	head = (head + 1) & SK_LINK_TX_MASK;
+	for (unsigned char i = 0; i < len; ++i) {
+		tx_buf[head] = bytes[i];
+		head = (head + 1) & SK_LINK_TX_MASK;
+	}
+	tx_head = head;
+
+	sk_arch_link_tx_start();
+	sk_arch_restore_int(state);
+
+	return true;
+}
+
+unsigned char sk_link_recv(unsigned char *channel, void *buf,
+			   unsigned char size)
+{
+	SK_ASSERT(channel);
+	SK_ASSERT(buf || !size);
+
+	sk_arch_disable_int();
+	while (rx_tail == rx_head) {
+		rx_task = task_current;
+		sk_task_await();
+		sk_arch_disable_int();
+	}
+	rx_task = NULL;
+	sk_arch_enable_int();
+
+	/* The RX interrupt only writes to the rx_head frame. */
+	const unsigned char *frame = rx_buf[rx_tail];
+	unsigned char len = rx_payload_len[rx_tail];
+	unsigned char *out = buf;
+	*channel = frame[0];
+	for (unsigned char i = 0; i < len && i < size; ++i) {
+		out[i] = frame[1 + i];
+	}
+
+	unsigned char next = rx_tail + 1;
+	rx_tail = next == SKIRT_LINK_RX_FRAMES ? 0 : next;
+
+	return len;
+}
+
+unsigned char sk_link_rx_errors(void)
+{
+	return rx_errors;
+}
+
+bool sk_link_send_stats(void)
+{
+	/* As many whole records as a frame holds. */
+	unsigned char frame[SKIRT_LINK_MTU - SKIRT_LINK_MTU % SK_LINK_STAT_SZ];
+	unsigned char len = 0;
+	bool sent = true;
+
+	for (sk_tid tid = 0; tid < SKIRT_TASK_MAX; ++tid) {
+		sk_task *task = sk_task_from_id(tid);
+		if (!task) {
+			continue;
+		}
+		if (len == sizeof frame) {
+			sent &= sk_link_send(SK_LINK_STATS, frame, len);
+			len = 0;
+		}
+
+#ifdef SKIRT_STACK_CHECK
+		sk_size_t unused = sk_task_stack_unused(task);
+#else
+		sk_size_t unused = 0xffff;
+#endif /* SKIRT_STACK_CHECK */
+#ifdef SKIRT_TASK_STATS
+		sk_task_stats stats;
+		sk_task_stats_get(task, &stats);
+		unsigned char share = stats.cpu_percent;
+#else
+		unsigned char share = 0xff;
+#endif /* SKIRT_TASK_STATS */
+
+		unsigned char *rec = &frame[len];
+		rec[0] = tid;
+		rec[1] = task->state;
+		rec[2] = (unsigned char)task->priority;
+		rec[3] = (unsigned char)unused;
+		rec[4] = (unsigned char)(unused >> 8);
+		rec[5] = share;
+		len += SK_LINK_STAT_SZ;
+	}
+
+	if (len) {
+		sent &= sk_link_send(SK_LINK_STATS, frame, len);
+	}
+
+	return sent;
+}
+
+#endif /* SKIRT_LINK */
@@ -0,0 +1,186 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Deferred logging ring buffer and log task.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/log.h>
+#include <sk/serial.h>
+#include <sk/link.h>
+
+#ifdef SKIRT_LOG
+
+#define SK_LOG_MASK (SKIRT_LOG_SZ - 1)
+
+/* Longest zigzag varint of a long, 7 bits per byte. */
+#define SK_LOG_VARINT_MAX ((sizeof(long) * 8 + 6) / 7)
+
+/* Longest record payload, format ID and arguments. */
+#define SK_LOG_PAYLOAD_MAX (SK_LOG_VARINT_MAX * (1 + SK_LOG_ARGS_MAX))
+
+#ifdef SKIRT_LINK
+_Static_assert(SKIRT_LINK_MTU >= SK_LOG_PAYLOAD_MAX,
+	       "SKIRT_LINK_MTU cannot hold a log record!");
+#endif /* SKIRT_LINK */
+
+/*
+ * Format IDs are relative to this string so they do not depend on where the
+ * image is loaded, it is also the format of the "records lost" record.
+ */
+const char sk_log_anchor[] SK_PROGMEM = "# %u log records lost";
+
+static sk_stack_t log_stack[SKIRT_LOG_STACK_SZ];
+static sk_task *log_task = NULL;
+
+static unsigned char log_buf[SKIRT_LOG_SZ];
+/* Single bytes so the log task can read them without disabling interrupts. */
+static volatile unsigned char log_head = 0;
+static volatile unsigned char log_tail = 0;
+static volatile unsigned char log_lost = 0;
+
+static unsigned char sk_log_varint(unsigned char *out, long value)
+{
+	/* Zigzag, small negative numbers stay short. */
+	unsigned long v = ((unsigned long)value << 1) ^
+			  (unsigned long)(value >> (sizeof(long) * 8 - 1));
+	unsigned char len = 0;
+
+	while (v >= 0x80) {
+		out[len++] = (unsigned char)(v | 0x80);
+		v >>= 7;
+	}
+	out[len++] = (unsigned char)v;
+
+	return len;
+}
+
+/* Sends whatever is queued, records written meanwhile are left for the next batch. */
+static SK_NORETURN void sk_log_task(void)
+{
+	for (;;) {
+		sk_arch_disable_int();
+		unsigned char end = log_head;
+		unsigned char lost = log_lost;
+		if (end == log_tail && !lost) {
+			sk_task_await();
+			continue;
+		}
+		log_lost = 0;
+		sk_arch_enable_int();
+
+		unsigned char i = log_tail;
+#ifdef SKIRT_LINK
+		/* One frame per record, the link has its own delimiter and length. */
+		while (i != end) {
+			unsigned char payload[SK_LOG_PAYLOAD_MAX];
+			unsigned char len = log_buf[(i + 1) & SK_LOG_MASK];
+			i = (i + 2) & SK_LOG_MASK;
+			for (unsigned char j = 0; j < len; ++j) {
+				payload[j] = log_buf[i];
+				i = (i + 1) & SK_LOG_MASK;
+			}
+			while (!sk_link_send(SK_LINK_LOG, payload, len)) {
+				sk_task_sleep(1);
+			}
+			log_tail = i;
+		}
+#else
+		while (i != end) {
+			sk_serial_putc((char)log_buf[i]);
+			i = (i + 1) & SK_LOG_MASK;
+			/* Release each byte once sent. */
+			log_tail = i;
+		}
+#endif /* SKIRT_LINK */
+
+		if (lost) {
+			long count = lost;
+			sk_log_write(sk_log_anchor, 1, &count);
+		}
+	}
+	SK_VERIFY_NOT_REACHED();
+}
+
+void sk_log_init(void)
+{
+	log_task = sk_task_create_static(sk_log_task, SKIRT_LOG_PRIO,
+					 log_stack, sizeof log_stack);
+}
+
+bool sk_log_write(const char *fmt, unsigned char nargs, const long *args)
+{
+	SK_ASSERT(fmt);
+	SK_ASSERT(nargs <= SK_LOG_ARGS_MAX);
+
+	/* Encoded before entering the critical section. */
+	unsigned char rec[2 + SK_LOG_PAYLOAD_MAX];
+	unsigned char len = sk_log_varint(
+		&rec[2], (long)(sk_size_t)fmt - (long)(sk_size_t)sk_log_anchor);
+	for (unsigned char i = 0; i < nargs; ++i) {
+		len += sk_log_varint(&rec[2 + len], args[i]);
+	}
+	rec[0] = SK_LOG_MARK;
+	rec[1] = len;
+	len += 2;
+
+	sk_int_state_t state = sk_arch_save_int();
+	unsigned char used = (log_head - log_tail) & SK_LOG_MASK;
+	/* One byte is always left empty to tell full from empty. */
+	if (len > SKIRT_LOG_SZ - 1 - used) {
+		if (log_lost < 0xff) {
+			log_lost++;
+		}
+		sk_arch_restore_int(state);
+		return false;
+	}
+
+	unsigned char head = log_head;
+	for (unsigned char i = 0; i < len; ++i) {
+		log_buf[head] = rec[i];
+		head = (head + 1) & SK_LOG_MASK;
+	}
+	log_head = head;
+
+	if (log_task) {
+		sk_task_wake_isr(log_task);
+	}
+	sk_arch_restore_int(state);
+
+	return true;
+}
+
+#endif /* SKIRT_LOG */
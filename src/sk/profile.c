@@ -0,0 +1,133 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Statistical profiler sampled by the preemption timer.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/profile.h>
+#include <sk/arch.h>
+#include <sk/serial.h>
+
+#ifdef SKIRT_PROFILE
+
+static sk_profile_bin profile_bins[SKIRT_PROFILE_SZ];
+static unsigned char profile_used = 0;
+static unsigned long profile_dropped = 0;
+static unsigned long profile_samples = 0;
+
+void sk_profile_sample(unsigned long pc, sk_task *task)
+{
+	unsigned short bin = (unsigned short)(pc >> SKIRT_PROFILE_SHIFT);
+	sk_tid tid = sk_task_id(task);
+
+	profile_samples++;
+	for (unsigned char i = 0; i < profile_used; ++i) {
+		sk_profile_bin *b = &profile_bins[i];
+		if (b->bin == bin && b->tid == tid) {
+			if (b->count < 0xffff) {
+				b->count++;
+			}
+			return;
+		}
+	}
+
+	sk_profile_bin *b;
+	if (profile_used < SKIRT_PROFILE_SZ) {
+		b = &profile_bins[profile_used++];
+	} else {
+		/* Full, the coldest bin makes room so code running late (often
+		 * the hot loop) still gets one, its samples are dropped. */
+		b = &profile_bins[0];
+		for (unsigned char i = 1; i < SKIRT_PROFILE_SZ; ++i) {
+			if (profile_bins[i].count < b->count) {
+				b = &profile_bins[i];
+			}
+		}
+		profile_dropped += b->count;
+	}
+
+	b->bin = bin;
+	b->tid = tid;
+	b->count = 1;
+}
+
+void sk_profile_dump(void)
+{
+	sk_serial_print_P(SK_PSTR("# skirt profile\n\r"));
+	for (unsigned char i = 0;; ++i) {
+		/* Copy one entry at a time, printing is way longer than a tick. */
+		sk_arch_disable_int();
+		if (i >= profile_used) {
+			sk_arch_enable_int();
+			break;
+		}
+		sk_profile_bin b = profile_bins[i];
+		sk_arch_enable_int();
+
+		sk_serial_print_uint(b.tid);
+		sk_serial_putc(' ');
+		/* Byte address, as found in the ELF symbol table. */
+		sk_serial_print_uint((unsigned long)b.bin
+				     << (SKIRT_PROFILE_SHIFT + 1));
+		sk_serial_putc(' ');
+		sk_serial_print_uint(b.count);
+		sk_serial_print_P(SK_PSTR("\n\r"));
+	}
+
+	sk_arch_disable_int();
+	unsigned long dropped = profile_dropped;
+	unsigned long samples = profile_samples;
+	sk_arch_enable_int();
+	sk_serial_print_P(SK_PSTR("# dropped "));
+	sk_serial_print_uint(dropped);
+	sk_serial_print_P(SK_PSTR(" of "));
+	sk_serial_print_uint(samples);
+	sk_serial_print_P(SK_PSTR(" ("));
+	sk_serial_print_uint(samples ? dropped * 100ULL / samples : 0);
+	sk_serial_print_P(SK_PSTR("%)\n\r"));
+}
+
+void sk_profile_reset(void)
+{
+	sk_arch_disable_int();
+	profile_used = 0;
+	profile_dropped = 0;
+	profile_samples = 0;
+	sk_arch_enable_int();
+}
+
+#endif /* SKIRT_PROFILE */
@@ -0,0 +1,227 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Stackless tasks (protothreads), run by a single kernel task.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/pt.h>
+#include <sk/arch.h>
+
+#ifdef SKIRT_PT
+
+#ifdef SKIRT_ALLOC_STATIC
+static sk_pt pt_pool[SKIRT_PT_MAX] = { 0 };
+
+static inline sk_pt *sk_pt_alloc(void)
+{
+	for (sk_size_t i = 0; i < SKIRT_PT_MAX; ++i) {
+		if (pt_pool[i].func == NULL && pt_pool[i].mailbox == NULL) {
+			pt_pool[i].lc = 0;
+			pt_pool[i].wake = 0;
+			pt_pool[i].sleeping = false;
+			pt_pool[i].next = NULL;
+			return &pt_pool[i];
+		}
+	}
+
+	return NULL;
+}
+
+static inline void sk_pt_free(sk_pt *pt)
+{
+	SK_ASSERT(pt);
+	if (pt < pt_pool || pt > &pt_pool[SKIRT_PT_MAX - 1]) {
+		SK_PANIC("Provided pt is not from the static pool!\n\r");
+	}
+	pt->func = NULL;
+}
+#else
+#error "Only SKIRT_ALLOC_STATIC is currently supported!"
+#endif /* SKIRT_ALLOC_STATIC */
+
+static sk_stack_t pt_stack[SKIRT_PT_STACK_SZ];
+sk_task *pt_runner = NULL;
+/* Sorted by decreasing priority. */
+static sk_pt *volatile pt_head = NULL;
+
+/**
+ * @brief Insert a protothread after those of higher or equal priority.
+ * @param pt Protothread to insert.
+ */
+static inline void sk_pt_insert(sk_pt *pt)
+{
+	if (!pt_head || pt_head->priority < pt->priority) {
+		pt->next = pt_head;
+		pt_head = pt;
+		return;
+	}
+
+	sk_pt *tmp = pt_head;
+	while (tmp->next && tmp->next->priority >= pt->priority) {
+		tmp = tmp->next;
+	}
+	pt->next = tmp->next;
+	tmp->next = pt;
+}
+
+static inline void sk_pt_remove(sk_pt *pt)
+{
+	if (pt == pt_head) {
+		pt_head = pt->next;
+		return;
+	}
+
+	sk_pt *tmp = pt_head;
+	while (tmp->next) {
+		if (tmp->next == pt) {
+			tmp->next = pt->next;
+			return;
+		}
+		tmp = tmp->next;
+	}
+}
+
+/* Tick count a comes before b, across wrap-arounds. */
+static inline bool sk_pt_before(sk_size_t a, sk_size_t b)
+{
+	return (sk_size_t)(b - a - 1) < ((sk_size_t)-1 >> 1);
+}
+
+/* Set by sk_pt_wake() while the runner scans protothreads. */
+static volatile bool pt_kicked = false;
+/* Earliest SK_PT_SLEEP() end while the runner waits. */
+static volatile bool pt_sleeping = false;
+static volatile sk_size_t pt_wake_at = 0;
+
+/* Run every protothread in priority order, scan again from the highest one
+ * if any yielded or exited, wait for sk_pt_wake() when all are blocked. */
+static SK_NORETURN void sk_pt_runner_task(void)
+{
+	for (;;) {
+		bool progress = false;
+		bool sleeping = false;
+		sk_size_t wake_at = 0;
+
+		pt_kicked = false;
+		sk_pt *pt = pt_head;
+		while (pt) {
+			sk_pt *next = pt->next;
+			char ret = pt->func(pt);
+			bool earlier = !sleeping ||
+				       sk_pt_before(pt->wake, wake_at);
+			if (ret != SK_PT_WAITING) {
+				progress = true;
+			} else if (pt->sleeping && earlier) {
+				wake_at = pt->wake;
+				sleeping = true;
+			}
+
+			if (ret == SK_PT_EXITED) {
+				sk_arch_disable_int();
+				sk_pt_remove(pt);
+				sk_pt_free(pt);
+				sk_arch_enable_int();
+				/* Not reallocated until its mailbox is empty. */
+				while (pt->mailbox) {
+					sk_pt_mail_pickup(pt);
+				}
+			}
+			pt = next;
+		}
+		if (progress) {
+			continue;
+		}
+
+		sk_arch_disable_int();
+		if (pt_kicked || (sleeping && sk_pt_elapsed(wake_at))) {
+			sk_arch_enable_int();
+			continue;
+		}
+		pt_sleeping = sleeping;
+		pt_wake_at = wake_at;
+		sk_task_await();
+	}
+	SK_VERIFY_NOT_REACHED();
+}
+
+sk_pt *sk_pt_create(sk_pt_func func, short priority, void *arg)
+{
+	SK_ASSERT(func);
+
+	if (!pt_runner) {
+		pt_runner = sk_task_create_static(sk_pt_runner_task,
+						  SKIRT_PT_PRIO, pt_stack,
+						  sizeof pt_stack);
+	}
+
+	sk_arch_disable_int();
+	sk_pt *pt = sk_pt_alloc();
+	SK_ASSERT(pt);
+	pt->func = func;
+	pt->arg = arg;
+	pt->priority = priority;
+	sk_pt_insert(pt);
+	sk_arch_enable_int();
+
+	return pt;
+}
+
+bool sk_pt_elapsed(sk_size_t wake)
+{
+	return (sk_size_t)(sk_kernel_ticks() - wake) < ((sk_size_t)-1 >> 1);
+}
+
+void sk_pt_wake(void)
+{
+	sk_int_state_t state = sk_arch_save_int();
+	pt_kicked = true;
+	if (pt_runner) {
+		sk_task_wake_isr(pt_runner);
+	}
+	sk_arch_restore_int(state);
+}
+
+void sk_pt_tick(void)
+{
+	if (pt_sleeping && sk_pt_elapsed(pt_wake_at)) {
+		pt_sleeping = false;
+		pt_kicked = true;
+		sk_task_wake_isr(pt_runner);
+	}
+}
+
+#endif /* SKIRT_PT */
@@ -39,16 +39,29 @@ knowledge of the CeCILL license and that you accept its terms.
  */
 #include <sk/skirt.h>
 #include <sk/arch.h>
+#include <sk/dpc.h>
+#include <sk/timer.h>
+#include <sk/log.h>
+#include <sk/link.h>
 
 extern sk_task *volatile task_current;
 
 static sk_stack_t idle_stack[SKIRT_TASK_STACK_SZ];
 
+_Static_assert(SKIRT_TASK_MAX > SK_KERNEL_TASKS,
+	       "SKIRT_TASK_MAX leaves no room for application tasks!");
+_Static_assert(SKIRT_TASK_STACK_SZ > SK_CONTEXT_SZ + 2,
+	       "SKIRT_TASK_STACK_SZ cannot hold a saved context!");
+
+/* Incremented by the preemption timer. */
+volatile sk_size_t kernel_ticks;
+sk_task *task_idle;
+
 /* Idling task, always ready. */
 SK_NOOPTI SK_NORETURN void sk_kernel_idle_task(void)
 {
 	for (;;) {
-		sk_arch_nop();
+		sk_arch_idle();
 	}
 	SK_VERIFY_NOT_REACHED();
 }
@@ -56,12 +69,34 @@ SK_NOOPTI SK_NORETURN void sk_kernel_idle_task(void)
 void sk_kernel_start(void)
 {
 	sk_arch_serial_init();
-	sk_task *idle = sk_task_create_static(sk_kernel_idle_task, 0,
-					      idle_stack, sizeof idle_stack);
+	task_idle = sk_task_create_static(sk_kernel_idle_task, 0, idle_stack,
+					 sizeof idle_stack);
+#ifdef SKIRT_DPC
+	sk_dpc_init();
+#endif /* SKIRT_DPC */
+#ifdef SKIRT_TIMER
+	sk_timer_init();
+#endif /* SKIRT_TIMER */
+#ifdef SKIRT_LOG
+	sk_log_init();
+#endif /* SKIRT_LOG */
 	sk_arch_init_preempt();
+#ifdef SKIRT_LINK
+	/* Serial interrupts only fire once the first task runs. */
+	sk_link_init();
+#endif /* SKIRT_LINK */
 
-	task_current = idle;
+	task_current = task_idle;
+	sk_arch_kernel_stack_init();
 	sk_arch_first_yield(task_current);
 
 	SK_VERIFY_NOT_REACHED();
 }
+
+sk_size_t sk_kernel_ticks(void)
+{
+	sk_int_state_t state = sk_arch_save_int();
+	sk_size_t ticks = kernel_ticks;
+	sk_arch_restore_int(state);
+	return ticks;
+}
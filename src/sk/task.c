@@ -40,9 +40,29 @@ knowledge of the CeCILL license and that you accept its terms.
  */
 #include <sk/task.h>
 #include <sk/arch.h>
+#include <sk/serial.h>
+#include <sk/trace.h>
+#include <sk/timer.h>
+#include <sk/ipc.h>
+#include <sk/pt.h>
 
 sk_task *volatile task_head;
 sk_task *volatile task_current;
+/* Set when an ISR made a task READY that should run before task_current. */
+volatile bool task_resched;
+extern sk_task *task_idle;
+
+#ifdef SKIRT_TASK_STATS
+extern volatile sk_size_t kernel_ticks;
+
+/* Preemption timer count at the last switch. */
+static sk_size_t stats_stamp;
+static sk_size_t stats_stamp_tick;
+/* Preemption timer counts since kernel start, at the beginning of the window. */
+static unsigned long stats_total;
+static unsigned long stats_window_start;
+static sk_size_t stats_window_tick;
+#endif /* SKIRT_TASK_STATS */
 
 #ifdef SKIRT_ALLOC_STATIC
 static sk_task task_pool[SKIRT_TASK_MAX] = { 0 };
@@ -51,16 +71,38 @@ static inline sk_task *sk_task_alloc(void)
 {
 	for (sk_size_t i = 0; i < SKIRT_TASK_MAX; ++i) {
 		if (task_pool[i].stack == NULL) {
-			task_pool[i].next = NULL;
+			task_pool[i].next = SK_TID_NONE;
 			task_pool[i].sp = NULL;
+#ifdef SKIRT_MAIL
 			task_pool[i].mailbox = NULL;
+#endif /* SKIRT_MAIL */
+#ifdef SKIRT_SIG
+			task_pool[i].sig_pending = 0;
+			task_pool[i].sig_blocked = 0;
+			task_pool[i].sig_frame = false;
+#endif /* SKIRT_SIG */
+#ifdef SKIRT_MSG
+			task_pool[i].msg_queue = NULL;
+			task_pool[i].msg_server = NULL;
+			task_pool[i].msg_receiving = false;
+#endif /* SKIRT_MSG */
 			task_pool[i].priority = 0;
 			task_pool[i].stack_sz = 0;
+			task_pool[i].sleeping = 0;
+#ifdef SKIRT_TASK_STATS
 			task_pool[i].counter.since_creation = 0;
 			task_pool[i].counter.waiting = 0;
 			task_pool[i].counter.running = 0;
-			task_pool[i].counter.sleeping = 0;
 			task_pool[i].counter.ready = 0;
+			task_pool[i].counter.switches = 0;
+			task_pool[i].counter.runtime = 0;
+			task_pool[i].counter.window_start = 0;
+			task_pool[i].counter.share = 0;
+#endif /* SKIRT_TASK_STATS */
+#ifdef SKIRT_LATENCY
+			task_pool[i].wake = (sk_latency){ 0 };
+			task_pool[i].woken = false;
+#endif /* SKIRT_LATENCY */
 			return &task_pool[i];
 		}
 	}
@@ -76,6 +118,21 @@ static inline void sk_task_free(sk_task *task)
 	}
 	task->stack = NULL;
 }
+
+/**
+ * @brief Follow a task ID link.
+ * @param tid Task ID or SK_TID_NONE.
+ * @return Task or NULL.
+ */
+static inline sk_task *sk_task_get(sk_tid tid)
+{
+	return tid == SK_TID_NONE ? NULL : &task_pool[tid];
+}
+
+static inline sk_tid sk_task_tid(sk_task *task)
+{
+	return (sk_tid)(task - task_pool);
+}
 #else
 #error "Only SKIRT_ALLOC_STATIC is currently supported!"
 #endif
@@ -90,7 +147,7 @@ static inline void sk_task_prepend(sk_task *task)
 		task_head = task;
 		return;
 	}
-	task->next = task_head;
+	task->next = sk_task_tid(task_head);
 	task_head = task;
 }
 
@@ -99,90 +156,173 @@ static inline void sk_task_remove(sk_task *task)
 	SK_ASSERT(task_head);
 
 	if (task == task_head) {
-		task_head = task_head->next;
+		task_head = sk_task_get(task_head->next);
 		return;
 	}
 
+	sk_tid tid = sk_task_tid(task);
 	sk_task *tmp = task_head;
-	while (tmp->next) {
-		if (tmp->next == task) {
+	while (tmp->next != SK_TID_NONE) {
+		if (tmp->next == tid) {
 			tmp->next = task->next;
 			return;
 		}
-		tmp = tmp->next;
+		tmp = sk_task_get(tmp->next);
 	}
 }
 
+#ifdef SKIRT_LATENCY
+/* Start measuring the wake-up latency of a task made READY. */
+static inline void sk_task_woken(sk_task *task)
+{
+	task->woken_at = sk_latency_now();
+	task->woken = true;
+}
+
+static inline void sk_task_switched_in(sk_task *task)
+{
+	if (task->woken) {
+		sk_latency_add(&task->wake,
+			       sk_latency_now() - task->woken_at);
+		task->woken = false;
+	}
+}
+#else
+#define sk_task_woken(task) \
+	do {                \
+	} while (0)
+#define sk_task_switched_in(task) \
+	do {                      \
+	} while (0)
+#endif /* SKIRT_LATENCY */
+
 static inline void sk_task_update_counters(void)
 {
 	sk_task *tmp = task_head;
 	while (tmp) {
+#ifdef SKIRT_TASK_STATS
 		tmp->counter.since_creation++;
+#endif /* SKIRT_TASK_STATS */
 		switch (tmp->state) {
+#ifdef SKIRT_TASK_STATS
 		case RUNNING:
 			tmp->counter.running++;
 			break;
 		case WAITING:
 			tmp->counter.waiting++;
 			break;
+		case READY:
+			tmp->counter.ready++;
+			break;
+#endif /* SKIRT_TASK_STATS */
 		case SLEEPING:
-			tmp->counter.sleeping--;
-			if (tmp->counter.sleeping == 0) {
+			tmp->sleeping--;
+			if (tmp->sleeping == 0) {
 				tmp->state = READY;
+				sk_task_woken(tmp);
 			}
 			break;
-		case READY:
-			tmp->counter.ready++;
+		default:
 			break;
 		}
-		tmp = tmp->next;
+		tmp = sk_task_get(tmp->next);
+	}
+}
+
+#ifdef SKIRT_TASK_STATS
+/**
+ * @brief Charge time elapsed since the last switch to the outgoing task.
+ * @note The preemption timer restarts every tick, a task running through
+ * several ticks is charged a whole period for each of them.
+ */
+static inline void sk_task_account(void)
+{
+	sk_size_t now = sk_arch_timer_now();
+	sk_size_t ticks = kernel_ticks;
+
+	/* The timer wrapped but its interrupt is still pending. */
+	if (sk_arch_timer_wrapped() && now < SK_ARCH_TIMER_PERIOD / 2) {
+		ticks++;
+	}
+
+	sk_size_t passed = ticks - stats_stamp_tick;
+	unsigned long elapsed = (unsigned long)passed * SK_ARCH_TIMER_PERIOD +
+				now - stats_stamp;
+	stats_stamp = now;
+	stats_stamp_tick = ticks;
+	stats_total += elapsed;
+	if (task_current) {
+		task_current->counter.runtime += elapsed;
+	}
+
+	if ((sk_size_t)(kernel_ticks - stats_window_tick) <
+	    SKIRT_STATS_WINDOW) {
+		return;
 	}
+
+	/* End of window, compute every task share. */
+	unsigned long window = stats_total - stats_window_start;
+	for (sk_task *tmp = task_head; tmp; tmp = sk_task_get(tmp->next)) {
+		unsigned long used = tmp->counter.runtime -
+				     tmp->counter.window_start;
+		tmp->counter.share =
+			window ? (unsigned char)(used * 100ULL / window) : 0;
+		tmp->counter.window_start = tmp->counter.runtime;
+	}
+	stats_window_start = stats_total;
+	stats_window_tick = kernel_ticks;
 }
+#endif /* SKIRT_TASK_STATS */
 
 #ifdef SKIRT_HARD_PRIO
 /* Always yield to the highest priority READY'd task. */
 static inline SK_HOT sk_task *sk_task_find_ready(void)
 {
-	sk_task *elected = task_head;
+	/* The head may be a WAITING kernel task above every READY one. */
+	sk_task *elected = NULL;
 	sk_task *tmp = task_head;
 	while (tmp) {
 		if (tmp->state == READY &&
-		    (tmp->priority > elected->priority)) {
+		    (!elected || tmp->priority > elected->priority)) {
 			elected = tmp;
 		}
-		tmp = tmp->next;
+		tmp = sk_task_get(tmp->next);
 	}
 
 	return elected;
 }
 
 #else
-/* Simple round-robin. */
+/* Simple round-robin, the idle task only runs when nothing else is READY. */
 static inline SK_HOT sk_task *sk_task_find_ready(void)
 {
 	sk_task *tmp = task_current;
-	while (tmp->next) {
-		tmp = tmp->next;
-		if (tmp->state == READY) {
+	while (tmp->next != SK_TID_NONE) {
+		tmp = sk_task_get(tmp->next);
+		if (tmp->state == READY && tmp != task_idle) {
 			return tmp;
 		}
 	}
 
 	tmp = task_head;
-	do {
-		if (tmp->state == READY) {
+	while (tmp) {
+		if (tmp->state == READY && tmp != task_idle) {
 			return tmp;
 		}
-		tmp = tmp->next;
-	} while (tmp->next);
+		tmp = sk_task_get(tmp->next);
+	}
 
-	return NULL;
+	return task_idle;
 }
 #endif /* SKIRT_HARD_PRIO */
 
-void sk_task_switch(void)
+void sk_task_schedule(void)
 {
-	sk_task_update_counters();
+	task_resched = false;
+
+#ifdef SKIRT_TASK_STATS
+	sk_task_account();
+#endif /* SKIRT_TASK_STATS */
 
 	if (!task_current) {
 		task_current = task_head;
@@ -195,9 +335,52 @@ void sk_task_switch(void)
 	sk_task *next = sk_task_find_ready();
 	SK_ASSERT(next);
 
-	next->state = RUNNING;
+#ifdef SKIRT_TASK_STATS
+	if (next != task_current) {
+		next->counter.switches++;
+	}
 	next->counter.ready = 0;
+#endif /* SKIRT_TASK_STATS */
+	if (next != task_current) {
+		SK_TRACE(SK_TRACE_SWITCH, sk_task_tid(next));
+	}
+	sk_task_switched_in(next);
+	next->state = RUNNING;
 	task_current = next;
+#ifdef SKIRT_SIG
+	sk_arch_sig_prepare(next);
+#endif /* SKIRT_SIG */
+}
+
+void sk_task_switch(void)
+{
+#ifdef SKIRT_TIMER
+	/* Wakes the service task before the next task is elected. */
+	sk_timer_tick();
+#endif /* SKIRT_TIMER */
+#ifdef SKIRT_PT
+	sk_pt_tick();
+#endif /* SKIRT_PT */
+	sk_task_update_counters();
+	sk_task_schedule();
+}
+
+void sk_task_wake_isr(sk_task *task)
+{
+	SK_ASSERT(task);
+	if (task->state != WAITING) {
+		return;
+	}
+	task->state = READY;
+	SK_TRACE(SK_TRACE_WAKE, sk_task_tid(task));
+	sk_task_woken(task);
+
+#ifdef SKIRT_HARD_PRIO
+	if (task_current && task->priority <= task_current->priority) {
+		return;
+	}
+#endif /* SKIRT_HARD_PRIO */
+	task_resched = true;
 }
 
 // ------------------
@@ -209,17 +392,46 @@ sk_task *sk_task_create_static(sk_task_func func, short priority, void *stack,
 {
 	sk_task *task = sk_task_alloc();
 	SK_ASSERT(task);
+	SK_ASSERT(priority >= -128 && priority <= 127);
 	sk_task_prepend(task);
 
 	task->stack = stack;
 	task->stack_sz = stack_sz;
-	task->priority = priority;
+	task->priority = (signed char)priority;
+#ifdef SKIRT_MSG
+	task->base_priority = task->priority;
+#endif /* SKIRT_MSG */
 	task->state = READY;
 
+#ifdef SKIRT_STACK_CHECK
+	for (sk_size_t i = 0; i < stack_sz; ++i) {
+		task->stack[i] = SKIRT_STACK_PATTERN;
+	}
+#endif /* SKIRT_STACK_CHECK */
 	sk_arch_stack_init(func, task);
 
 	return task;
 }
+sk_tid sk_task_id(sk_task *task)
+{
+	SK_ASSERT(task);
+	return sk_task_tid(task);
+}
+
+sk_task *sk_task_from_id(sk_tid tid)
+{
+	if (tid >= SKIRT_TASK_MAX || !task_pool[tid].stack) {
+		return NULL;
+	}
+	return &task_pool[tid];
+}
+
+sk_tid sk_task_self(void)
+{
+	SK_ASSERT(task_current);
+	return sk_task_tid(task_current);
+}
+
 void sk_task_kill(sk_task *task)
 {
 	sk_arch_disable_int();
@@ -243,16 +455,107 @@ void sk_task_sleep(sk_size_t time_ms)
 	sk_arch_disable_int();
 	SK_ASSERT(task_current);
 	/* TODO: Convert time_ms to nearest number of interrupts required. */
-	task_current->counter.sleeping = time_ms;
+	task_current->sleeping = time_ms;
 	task_current->state = SLEEPING;
 	sk_arch_yield();
 }
 
+#ifdef SKIRT_STACK_CHECK
+sk_size_t sk_task_stack_unused(sk_task *task)
+{
+	SK_ASSERT(task);
+
+	/* Stacks grow downward, untouched bytes are at the bottom. */
+	sk_size_t unused = 0;
+	while (unused < task->stack_sz &&
+	       task->stack[unused] == SKIRT_STACK_PATTERN) {
+		unused++;
+	}
+
+	return unused;
+}
+
+void sk_task_stack_report(void)
+{
+	sk_serial_print_P(SK_PSTR("Task\tPrio\tUsed\tSize\n\r"));
+	for (sk_size_t i = 0; i < SKIRT_TASK_MAX; ++i) {
+		sk_task *task = &task_pool[i];
+		if (!task->stack) {
+			continue;
+		}
+		sk_serial_print_uint(i);
+		sk_serial_putc('\t');
+		int priority = task->priority;
+		if (priority < 0) {
+			sk_serial_putc('-');
+			priority = -priority;
+		}
+		sk_serial_print_uint(priority);
+		sk_serial_putc('\t');
+		sk_serial_print_uint(task->stack_sz -
+				     sk_task_stack_unused(task));
+		sk_serial_putc('\t');
+		sk_serial_print_uint(task->stack_sz);
+		sk_serial_print_P(SK_PSTR("\n\r"));
+	}
+}
+#endif /* SKIRT_STACK_CHECK */
+
+#ifdef SKIRT_TASK_STATS
+void sk_task_stats_get(sk_task *task, sk_task_stats *stats)
+{
+	SK_ASSERT(task);
+	SK_ASSERT(stats);
+
+	sk_arch_disable_int();
+	stats->cpu_percent = task->counter.share;
+	stats->runtime_us = sk_arch_timer_to_us(task->counter.runtime);
+	stats->switches = task->counter.switches;
+	stats->running = task->counter.running;
+	stats->waiting = task->counter.waiting;
+	stats->ready = task->counter.ready;
+	stats->since_creation = task->counter.since_creation;
+	sk_arch_enable_int();
+}
+
+unsigned char sk_kernel_idle_percent(void)
+{
+	sk_arch_disable_int();
+	unsigned char idle = task_idle ? task_idle->counter.share : 0;
+	sk_arch_enable_int();
+	return idle;
+}
+#endif /* SKIRT_TASK_STATS */
+
+#ifdef SKIRT_LATENCY
+void sk_task_latency_get(sk_task *task, sk_latency *lat)
+{
+	SK_ASSERT(task);
+	SK_ASSERT(lat);
+
+	sk_arch_disable_int();
+	*lat = task->wake;
+	sk_arch_enable_int();
+}
+
+void sk_task_latency_reset(sk_task *task)
+{
+	SK_ASSERT(task);
+
+	sk_arch_disable_int();
+	task->wake = (sk_latency){ 0 };
+	task->woken = false;
+	sk_arch_enable_int();
+}
+#endif /* SKIRT_LATENCY */
+
 void sk_task_awake(sk_task *task)
 {
 	sk_arch_disable_int();
 	SK_ASSERT(task);
 	task->state = READY;
+	SK_TRACE(SK_TRACE_WAKE, sk_task_tid(task));
+	sk_task_woken(task);
 	sk_arch_enable_int();
 }
 
@@ -0,0 +1,246 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Software timers, callbacks are run by a kernel service task.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/timer.h>
+#include <sk/arch.h>
+
+#ifdef SKIRT_TIMER
+
+#define SK_TIMER_FREE 0
+#define SK_TIMER_IDLE 1
+#define SK_TIMER_ACTIVE 2
+
+static sk_timer timer_pool[SKIRT_TIMER_MAX] = { 0 };
+
+static sk_stack_t timer_stack[SKIRT_TIMER_STACK_SZ];
+static sk_task *timer_service = NULL;
+
+/* The first active timer always has a delta of at least 1 between ticks. */
+static sk_timer *timer_active = NULL;
+static sk_timer *timer_fired = NULL;
+static sk_timer *timer_fired_tail = NULL;
+
+/* Timers expiring on the same tick keep the order they were started in. */
+static void sk_timer_insert(sk_timer *timer, sk_size_t ticks)
+{
+	sk_timer **link = &timer_active;
+	while (*link && (*link)->delta <= ticks) {
+		ticks -= (*link)->delta;
+		link = &(*link)->next;
+	}
+	if (*link) {
+		(*link)->delta -= ticks;
+	}
+	timer->delta = ticks;
+	timer->next = *link;
+	timer->state = SK_TIMER_ACTIVE;
+	*link = timer;
+}
+
+static void sk_timer_remove(sk_timer *timer)
+{
+	sk_timer **link = &timer_active;
+	while (*link != timer) {
+		link = &(*link)->next;
+	}
+	if (timer->next) {
+		timer->next->delta += timer->delta;
+	}
+	*link = timer->next;
+	timer->state = SK_TIMER_IDLE;
+}
+
+static void sk_timer_unfire(sk_timer *timer)
+{
+	sk_timer *prev = NULL;
+	sk_timer *tmp = timer_fired;
+	while (tmp != timer) {
+		prev = tmp;
+		tmp = tmp->next_fired;
+	}
+	if (prev) {
+		prev->next_fired = timer->next_fired;
+	} else {
+		timer_fired = timer->next_fired;
+	}
+	if (timer_fired_tail == timer) {
+		timer_fired_tail = prev;
+	}
+	timer->fired = false;
+}
+
+/* Interrupts must be disabled. */
+static bool sk_timer_cancel(sk_timer *timer)
+{
+	bool pending = timer->fired || timer->state == SK_TIMER_ACTIVE;
+	if (timer->state == SK_TIMER_ACTIVE) {
+		sk_timer_remove(timer);
+	}
+	if (timer->fired) {
+		sk_timer_unfire(timer);
+	}
+	return pending;
+}
+
+/* Runs every expired callback, then waits for the next tick expiring one. */
+static SK_NORETURN void sk_timer_service_task(void)
+{
+	for (;;) {
+		sk_arch_disable_int();
+		sk_timer *timer = timer_fired;
+		if (!timer) {
+			sk_task_await();
+			continue;
+		}
+		timer_fired = timer->next_fired;
+		timer->fired = false;
+		sk_timer_func func = timer->func;
+		void *arg = timer->arg;
+		sk_arch_enable_int();
+
+		func(arg);
+	}
+	SK_VERIFY_NOT_REACHED();
+}
+
+void sk_timer_init(void)
+{
+	timer_service = sk_task_create_static(sk_timer_service_task,
+					      SKIRT_TIMER_PRIO, timer_stack,
+					      sizeof timer_stack);
+}
+
+void sk_timer_tick(void)
+{
+	if (!timer_active) {
+		return;
+	}
+
+	timer_active->delta--;
+	while (timer_active && timer_active->delta == 0) {
+		sk_timer *timer = timer_active;
+		timer_active = timer->next;
+		if (timer->period) {
+			sk_timer_insert(timer, timer->period);
+		} else {
+			timer->state = SK_TIMER_IDLE;
+		}
+
+		/* A periodic timer whose callback is late only runs it once. */
+		if (timer->fired) {
+			continue;
+		}
+		timer->fired = true;
+		timer->next_fired = NULL;
+		if (timer_fired) {
+			timer_fired_tail->next_fired = timer;
+		} else {
+			timer_fired = timer;
+		}
+		timer_fired_tail = timer;
+	}
+
+	if (timer_fired && timer_service) {
+		sk_task_wake_isr(timer_service);
+	}
+}
+
+sk_timer *sk_timer_create(sk_timer_func func, void *arg)
+{
+	SK_ASSERT(func);
+
+	sk_arch_disable_int();
+	sk_timer *timer = NULL;
+	for (sk_size_t i = 0; i < SKIRT_TIMER_MAX; ++i) {
+		if (timer_pool[i].state == SK_TIMER_FREE) {
+			timer = &timer_pool[i];
+			break;
+		}
+	}
+	SK_ASSERT(timer);
+	timer->func = func;
+	timer->arg = arg;
+	timer->period = 0;
+	timer->fired = false;
+	timer->state = SK_TIMER_IDLE;
+	sk_arch_enable_int();
+
+	return timer;
+}
+
+void sk_timer_destroy(sk_timer *timer)
+{
+	SK_ASSERT(timer);
+	if (timer < timer_pool || timer > &timer_pool[SKIRT_TIMER_MAX - 1]) {
+		SK_PANIC("Provided timer is not from the static pool!\n\r");
+	}
+
+	sk_arch_disable_int();
+	sk_timer_cancel(timer);
+	timer->state = SK_TIMER_FREE;
+	sk_arch_enable_int();
+}
+
+void sk_timer_start(sk_timer *timer, sk_size_t ticks, sk_size_t period)
+{
+	SK_ASSERT(timer);
+	SK_ASSERT(timer->state != SK_TIMER_FREE);
+	SK_ASSERT(ticks);
+
+	sk_int_state_t state = sk_arch_save_int();
+	sk_timer_cancel(timer);
+	timer->period = period;
+	sk_timer_insert(timer, ticks);
+	sk_arch_restore_int(state);
+}
+
+bool sk_timer_stop(sk_timer *timer)
+{
+	SK_ASSERT(timer);
+	SK_ASSERT(timer->state != SK_TIMER_FREE);
+
+	sk_int_state_t state = sk_arch_save_int();
+	bool pending = sk_timer_cancel(timer);
+	sk_arch_restore_int(state);
+
+	return pending;
+}
+
+#endif /* SKIRT_TIMER */
@@ -0,0 +1,245 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Publish/subscribe topics.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/topic.h>
+#include <sk/arch.h>
+
+#ifdef SKIRT_TOPIC
+
+extern sk_task *volatile task_current;
+extern volatile bool task_resched;
+
+static sk_topic topic_pool[SKIRT_TOPIC_MAX] = { 0 };
+
+/* Interrupts must be disabled. */
+static void sk_topic_link(sk_topic *topic, sk_topic_sub *sub)
+{
+	sub->topic = topic;
+	sub->task = NULL;
+	sub->seq = topic->seq;
+	sub->waiting = false;
+	sub->next = topic->subs;
+	topic->subs = sub;
+}
+
+/* Interrupts must be disabled. */
+static bool sk_topic_pending(sk_topic_sub *sub)
+{
+	if (sub->queue) {
+		return sub->head != sub->tail;
+	}
+	return sub->seq != sub->topic->seq;
+}
+
+/* Interrupts must be disabled, a value must be pending. */
+static const void *sk_topic_pop(sk_topic_sub *sub, unsigned short *seq)
+{
+	const void *value;
+	if (sub->queue) {
+		value = sub->queue[sub->head].value;
+		sub->seq = sub->queue[sub->head].seq;
+		sub->head = (sub->head + 1) & sub->mask;
+	} else {
+		value = sub->topic->value;
+		sub->seq = sub->topic->seq;
+	}
+	if (seq) {
+		*seq = sub->seq;
+	}
+	return value;
+}
+
+sk_topic *sk_topic_create(void)
+{
+	sk_arch_disable_int();
+	sk_topic *topic = NULL;
+	for (sk_size_t i = 0; i < SKIRT_TOPIC_MAX; ++i) {
+		if (!topic_pool[i].used) {
+			topic = &topic_pool[i];
+			break;
+		}
+	}
+	SK_ASSERT(topic);
+	topic->value = NULL;
+	topic->subs = NULL;
+	topic->seq = 0;
+	topic->used = true;
+	sk_arch_enable_int();
+
+	return topic;
+}
+
+void sk_topic_subscribe(sk_topic *topic, sk_topic_sub *sub)
+{
+	SK_ASSERT(topic);
+	SK_ASSERT(sub);
+
+	sk_int_state_t state = sk_arch_save_int();
+	sub->queue = NULL;
+	sk_topic_link(topic, sub);
+	sk_arch_restore_int(state);
+}
+
+void sk_topic_subscribe_queue(sk_topic *topic, sk_topic_sub *sub,
+			      sk_topic_entry *queue, unsigned char size)
+{
+	SK_ASSERT(topic);
+	SK_ASSERT(sub);
+	SK_ASSERT(queue);
+	SK_ASSERT(size > 1 && size <= 128 && !(size & (size - 1)));
+
+	sk_int_state_t state = sk_arch_save_int();
+	sub->queue = queue;
+	sub->mask = size - 1;
+	sub->head = 0;
+	sub->tail = 0;
+	sub->lost = 0;
+	sk_topic_link(topic, sub);
+	sk_arch_restore_int(state);
+}
+
+void sk_topic_unsubscribe(sk_topic_sub *sub)
+{
+	SK_ASSERT(sub);
+	SK_ASSERT(sub->topic);
+
+	sk_int_state_t state = sk_arch_save_int();
+	sk_topic_sub **link = &sub->topic->subs;
+	while (*link != sub) {
+		SK_ASSERT(*link);
+		link = &(*link)->next;
+	}
+	*link = sub->next;
+	sub->topic = NULL;
+	sk_arch_restore_int(state);
+}
+
+void sk_topic_publish(sk_topic *topic, const void *value)
+{
+	SK_ASSERT(topic);
+
+	sk_int_state_t state = sk_arch_save_int();
+	topic->value = value;
+	topic->seq++;
+	for (sk_topic_sub *sub = topic->subs; sub; sub = sub->next) {
+		if (sub->queue) {
+			unsigned char next = (sub->tail + 1) & sub->mask;
+			if (next == sub->head) {
+				if (sub->lost < 0xff) {
+					sub->lost++;
+				}
+				continue;
+			}
+			sub->queue[sub->tail].value = value;
+			sub->queue[sub->tail].seq = topic->seq;
+			sub->tail = next;
+		}
+		if (sub->waiting) {
+			sub->waiting = false;
+			sk_task_wake_isr(sub->task);
+		}
+	}
+
+	/* Called by a task, a woken subscriber may have to run first. */
+	if (task_resched && task_current && sk_arch_int_enabled(state)) {
+		sk_arch_yield();
+		return;
+	}
+	sk_arch_restore_int(state);
+}
+
+const void *sk_topic_try_take(sk_topic_sub *sub, unsigned short *seq)
+{
+	SK_ASSERT(sub);
+	SK_ASSERT(sub->topic);
+
+	sk_int_state_t state = sk_arch_save_int();
+	const void *value = NULL;
+	if (sk_topic_pending(sub)) {
+		value = sk_topic_pop(sub, seq);
+	}
+	sk_arch_restore_int(state);
+
+	return value;
+}
+
+const void *sk_topic_take(sk_topic_sub *sub, unsigned short *seq)
+{
+	SK_ASSERT(sub);
+	SK_ASSERT(sub->topic);
+
+	sk_arch_disable_int();
+	SK_ASSERT(task_current);
+	while (!sk_topic_pending(sub)) {
+		sub->task = task_current;
+		sub->waiting = true;
+		sk_task_await();
+		sk_arch_disable_int();
+	}
+	sub->waiting = false;
+	const void *value = sk_topic_pop(sub, seq);
+	sk_arch_enable_int();
+
+	return value;
+}
+
+bool sk_topic_valid(sk_topic_sub *sub, unsigned short seq)
+{
+	SK_ASSERT(sub);
+	SK_ASSERT(sub->topic);
+
+	return sub->topic->seq == seq;
+}
+
+const void *sk_topic_latest(sk_topic *topic, unsigned short *seq)
+{
+	SK_ASSERT(topic);
+
+	sk_int_state_t state = sk_arch_save_int();
+	const void *value = topic->value;
+	if (seq) {
+		*seq = topic->seq;
+	}
+	sk_arch_restore_int(state);
+
+	return value;
+}
+
+#endif /* SKIRT_TOPIC */
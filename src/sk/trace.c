@@ -0,0 +1,176 @@
+/*
+Copyright or © or Copr. Pierre Boisselier (30 nov. 2022)
+
+skirt@pboisselier.fr
+
+This software is a computer program whose purpose is to [describe
+functionalities and technical features of your software].
+
+This software is governed by the CeCILL license under French law and
+abiding by the rules of distribution of free software.  You can  use,
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability.
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or
+data to be ensured and,  more generally, to use and operate it in the
+same conditions as regards security.
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+/**
+ * @brief Binary trace ring buffer.
+ * @copyright Copyright (c) 2022 Pierre Boisselier All rights reserved.
+ */
+
+#include <sk/trace.h>
+#include <sk/arch.h>
+#include <sk/serial.h>
+#include <sk/link.h>
+
+#ifdef SKIRT_TRACE
+
+#define SK_TRACE_MASK (SKIRT_TRACE_SZ - 1)
+
+extern volatile sk_size_t kernel_ticks;
+
+static sk_trace_rec trace_buf[SKIRT_TRACE_SZ];
+static volatile unsigned char trace_head = 0;
+static volatile unsigned char trace_tail = 0;
+static volatile unsigned char trace_lost = 0;
+
+void sk_trace_record(unsigned char event, unsigned char arg)
+{
+	sk_int_state_t state = sk_arch_save_int();
+
+	sk_size_t count = sk_arch_timer_now();
+	sk_size_t ticks = kernel_ticks;
+
+	/* The timer wrapped but its interrupt is still pending. */
+	if (sk_arch_timer_wrapped() && count < SK_ARCH_TIMER_PERIOD / 2) {
+		ticks++;
+	}
+
+	/* Continuous timer count, wraps every 65536 counts. */
+	unsigned short stamp =
+		(unsigned short)(ticks * SK_ARCH_TIMER_PERIOD + count);
+
+	sk_trace_rec *rec = &trace_buf[trace_head];
+	rec->event = event;
+	rec->arg = arg;
+	rec->stamp_lo = (unsigned char)(stamp & 0xff);
+	rec->stamp_hi = (unsigned char)(stamp >> 8);
+
+	trace_head = (trace_head + 1) & SK_TRACE_MASK;
+	if (trace_head == trace_tail) {
+		/* Full, drop the oldest record. */
+		trace_tail = (trace_tail + 1) & SK_TRACE_MASK;
+		if (trace_lost < 0xff) {
+			trace_lost++;
+		}
+	}
+
+	sk_arch_restore_int(state);
+}
+
+#ifdef SKIRT_LINK
+_Static_assert(SKIRT_LINK_MTU >= sizeof(sk_trace_rec),
+	       "SKIRT_LINK_MTU cannot hold a trace record!");
+
+/* Waits for room in the link queue, like sk_serial_putc() for the UART. */
+static void sk_trace_send(const unsigned char *frame, unsigned char len)
+{
+	while (!sk_link_send(SK_LINK_TRACE, frame, len))
+		;
+}
+#endif /* SKIRT_LINK */
+
+unsigned char sk_trace_flush(void)
+{
+	sk_arch_disable_int();
+	unsigned char lost = trace_lost;
+	unsigned char count = (trace_head - trace_tail) & SK_TRACE_MASK;
+	trace_lost = 0;
+	sk_arch_enable_int();
+
+	if (!count && !lost) {
+		return 0;
+	}
+
+#ifdef SKIRT_LINK
+	/* Whole records in each frame, the lost record goes first as well. */
+	unsigned char
+		frame[SKIRT_LINK_MTU - SKIRT_LINK_MTU % sizeof(sk_trace_rec)];
+	unsigned char len = 0;
+	if (lost) {
+		frame[len++] = SK_TRACE_LOST;
+		frame[len++] = lost;
+		frame[len++] = 0;
+		frame[len++] = 0;
+	}
+
+	for (unsigned char i = 0; i < count; ++i) {
+		if (len == sizeof frame) {
+			sk_trace_send(frame, len);
+			len = 0;
+		}
+
+		sk_arch_disable_int();
+		sk_trace_rec rec = trace_buf[trace_tail];
+		trace_tail = (trace_tail + 1) & SK_TRACE_MASK;
+		sk_arch_enable_int();
+
+		frame[len++] = rec.event;
+		frame[len++] = rec.arg;
+		frame[len++] = rec.stamp_lo;
+		frame[len++] = rec.stamp_hi;
+	}
+	if (len) {
+		sk_trace_send(frame, len);
+	}
+#else
+	sk_serial_putc((char)SK_TRACE_SYNC0);
+	sk_serial_putc((char)SK_TRACE_SYNC1);
+	sk_serial_putc((char)(count + (lost ? 1 : 0)));
+	if (lost) {
+		/* Timestamp is meaningless for this one. */
+		sk_serial_putc(SK_TRACE_LOST);
+		sk_serial_putc(lost);
+		sk_serial_putc(0);
+		sk_serial_putc(0);
+	}
+
+	/* One record at a time, the serial port is slow and must not be driven
+	 * with interrupts disabled. */
+	for (unsigned char i = 0; i < count; ++i) {
+		sk_arch_disable_int();
+		sk_trace_rec rec = trace_buf[trace_tail];
+		trace_tail = (trace_tail + 1) & SK_TRACE_MASK;
+		sk_arch_enable_int();
+
+		sk_serial_putc(rec.event);
+		sk_serial_putc(rec.arg);
+		sk_serial_putc(rec.stamp_lo);
+		sk_serial_putc(rec.stamp_hi);
+	}
+#endif /* SKIRT_LINK */
+
+	return count;
+}
+
+#endif /* SKIRT_TRACE */
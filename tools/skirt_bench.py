@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+Run SKIRT benchmarks under simavr and collect their cycle reports.
+
+Each benchmark prints "BENCH <name> <param> <iterations> <cycles> <per iteration>"
+lines (see src/benchmarks/bench.h) and ends by sleeping with interrupts
+disabled, which makes simavr exit.
+
+    skirt_bench.py build/bench_*.elf -o report.json
+    skirt_bench.py build/bench_*.elf --baseline old.json --threshold 5
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+LINE = re.compile(r"BENCH (\S+) (\d+) (\d+) (\d+) (\d+)")
+
+
+def run(simavr, mcu, freq, elf, timeout):
+    proc = subprocess.run([simavr, "-m", mcu, "-f", str(freq), elf],
+                          stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                          text=True, errors="replace", timeout=timeout)
+    output = proc.stdout
+    if "BENCH END" not in output:
+        sys.exit("%s did not finish:\n%s" % (elf, output))
+
+    results = []
+    for m in LINE.finditer(output):
+        name, param, iters, cycles, per_iter = m.groups()
+        results.append({"benchmark": os.path.basename(elf),
+                        "name": name, "param": int(param),
+                        "iterations": int(iters), "cycles": int(cycles),
+                        "cycles_per_iteration": int(per_iter)})
+    return results
+
+
+def key(result):
+    return "%s/%d" % (result["name"], result["param"])
+
+
+def compare(results, baseline, threshold):
+    """Print the difference with a previous report, return True on regression."""
+    old = {key(r): r for r in baseline}
+    regressed = False
+    print("%-24s %10s %10s %8s" % ("benchmark", "before", "after", "delta"))
+    for r in results:
+        before = old.get(key(r))
+        after = r["cycles_per_iteration"]
+        if not before:
+            print("%-24s %10s %10d %8s" % (key(r), "-", after, "new"))
+            continue
+        before = before["cycles_per_iteration"]
+        delta = 100.0 * (after - before) / before if before else 0.0
+        flag = ""
+        if delta > threshold:
+            flag = "  REGRESSION"
+            regressed = True
+        print("%-24s %10d %10d %+7.1f%%%s" % (key(r), before, after, delta,
+                                               flag))
+    return regressed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("elf", nargs="+", help="benchmark ELF files")
+    parser.add_argument("-o", "--output", help="JSON report (stdout if not set)")
+    parser.add_argument("--simavr", default="simavr", help="simavr executable")
+    parser.add_argument("--mcu", default="atmega328p")
+    parser.add_argument("--freq", type=int, default=16000000)
+    parser.add_argument("--timeout", type=float, default=60.0,
+                        help="seconds before giving up on a benchmark")
+    parser.add_argument("--baseline", help="previous JSON report to compare with")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="regression threshold in percent")
+    args = parser.parse_args()
+
+    results = []
+    for elf in args.elf:
+        results += run(args.simavr, args.mcu, args.freq, elf, args.timeout)
+
+    report = {"mcu": args.mcu, "freq": args.freq, "results": results}
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=1)
+    elif not args.baseline:
+        json.dump(report, sys.stdout, indent=1)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)["results"]
+        if compare(results, baseline, args.threshold):
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
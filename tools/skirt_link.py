@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""
+Read frames from a SKIRT framed link (see include/sk/link.h), or send one.
+
+The stream is split on 0x00, each frame is COBS decoded and its CRC-16
+checked, then shown by channel: log records are expanded with the firmware
+ELF, trace records can be saved for skirt_trace.py, task statistics are
+printed as a table and application frames as hex. The input can be a capture
+file, "-" for stdin or a serial port (needs pyserial), read until Ctrl-C.
+
+    skirt_link.py /dev/ttyACM0 --elf firmware.elf --trace trace.bin
+    ./link.elf | skirt_link.py - --elf link.elf
+    skirt_link.py --send 16 68656c6c6f > frame.bin
+"""
+
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import skirt_log  # noqa: E402
+
+# Keep in sync with include/sk/link.h.
+LOG = 0
+TRACE = 1
+STATS = 2
+APP = 16
+CRC_INIT = 0xFFFF
+STAT_SZ = 6
+
+# Keep in sync with sk_state in include/sk/task.h.
+STATES = ["RUNNING", "READY", "WAITING", "SLEEPING"]
+
+# Block header understood by skirt_trace.py.
+TRACE_SYNC = b"\xa5\x5a"
+TRACE_REC_SZ = 4
+
+
+def crc16(data, crc=CRC_INIT):
+    """CRC-16/CCITT-FALSE, same bytewise form as the firmware."""
+    for byte in data:
+        x = (crc >> 8) ^ byte
+        x ^= x >> 4
+        crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray()
+    for block in bytes(data).split(b"\0"):
+        while len(block) >= 254:
+            out += b"\xff" + block[:254]
+            block = block[254:]
+        out.append(len(block) + 1)
+        out += block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        if not code or pos + code > len(data):
+            raise ValueError("bad COBS code")
+        out += data[pos + 1:pos + code]
+        pos += code
+        if code != 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def encode_frame(channel, payload):
+    data = bytes([channel]) + bytes(payload)
+    crc = crc16(data)
+    return cobs_encode(data + bytes([crc >> 8, crc & 0xFF])) + b"\0"
+
+
+class Reader:
+    """Split a byte stream into (channel, payload) frames."""
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.frames = 0
+        self.errors = 0
+
+    def feed(self, data):
+        self.pending += data
+        while True:
+            end = self.pending.find(0)
+            if end < 0:
+                return
+            raw = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if not raw:
+                continue
+            try:
+                frame = cobs_decode(raw)
+            except ValueError:
+                frame = b""
+            if len(frame) < 3 or crc16(frame):
+                self.errors += 1
+                continue
+            self.frames += 1
+            yield frame[0], frame[1:-2]
+
+
+class Printer:
+    def __init__(self, out, elf, trace):
+        self.out = out
+        self.log = skirt_log.Decoder(skirt_log.Elf(elf), out) if elf else None
+        self.trace = trace
+
+    def frame(self, channel, payload):
+        if channel == LOG:
+            if self.log:
+                self.log.record(payload)
+            else:
+                self.line(f"log {skirt_log.read_varints(payload)}")
+        elif channel == TRACE:
+            records = len(payload) // TRACE_REC_SZ
+            if self.trace:
+                self.trace.write(TRACE_SYNC + bytes([records]) +
+                                 payload[:records * TRACE_REC_SZ])
+                self.trace.flush()
+            else:
+                self.line(f"trace {records} records")
+        elif channel == STATS:
+            self.stats(payload)
+        else:
+            self.line(f"ch{channel} {payload.hex(' ')}")
+
+    def stats(self, payload):
+        self.line("tid state    prio unused cpu")
+        for i in range(0, len(payload) - STAT_SZ + 1, STAT_SZ):
+            tid, state, prio, lo, hi, cpu = payload[i:i + STAT_SZ]
+            unused = lo | (hi << 8)
+            prio -= 256 if prio > 127 else 0
+            name = STATES[state] if state < len(STATES) else str(state)
+            self.line(f"{tid:3} {name:8} {prio:4} "
+                      f"{'-' if unused == 0xFFFF else unused:>6} "
+                      f"{'-' if cpu == 0xFF else str(cpu) + '%':>4}")
+
+    def line(self, text):
+        self.out.write(text + "\n")
+        self.out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("input", nargs="?", default="-",
+                        help="capture file, serial port or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--elf", help="firmware ELF file, expands log records")
+    parser.add_argument("--trace", help="append trace records to this file, "
+                        "for skirt_trace.py")
+    parser.add_argument("--send", nargs=2, metavar=("CHANNEL", "HEX"),
+                        help="write one frame to the serial port or stdout "
+                        "and exit")
+    parser.add_argument("--stats", action="store_true",
+                        help="print frame and error counts on exit")
+    args = parser.parse_args()
+
+    if args.send:
+        frame = encode_frame(int(args.send[0], 0), bytes.fromhex(args.send[1]))
+        if args.input.startswith("/dev/"):
+            import serial  # Only needed for live captures.
+
+            with serial.Serial(args.input, args.baud) as port:
+                port.write(frame)
+        else:
+            sys.stdout.buffer.write(frame)
+            sys.stdout.flush()
+        return
+
+    trace = open(args.trace, "ab") if args.trace else None
+    printer = Printer(sys.stdout, args.elf, trace)
+    reader = Reader()
+    try:
+        for chunk in skirt_log.chunks(args.input, args.baud):
+            for channel, payload in reader.feed(chunk):
+                printer.frame(channel, payload)
+    except (KeyboardInterrupt, BrokenPipeError):
+        pass
+    if trace:
+        trace.close()
+
+    if args.stats:
+        print(f"# {reader.frames} frames, {reader.errors} bad", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""
+Expand SKIRT deferred log records (see include/sk/log.h) back into text.
+
+The input is the raw serial stream: plain text is passed through, records
+are looked up in the firmware ELF and formatted. It can be a capture file,
+"-" for stdin or a serial port (needs pyserial), which is read until Ctrl-C.
+
+    skirt_log.py firmware.elf capture.bin
+    skirt_log.py firmware.elf /dev/ttyACM0 --baud 115200
+    ./logging.elf | skirt_log.py logging.elf - --stats
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# Keep in sync with include/sk/log.h.
+MARK = 0x00
+ANCHOR = "sk_log_anchor"
+
+EM_AVR = 83
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 2
+
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z)?([diuxXoc%])")
+
+
+class Elf:
+    """Just enough of an ELF reader to find a symbol and read constant strings."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError(f"{path} is not an ELF file")
+        self.is64 = self.data[4] == 2
+        self.endian = "<" if self.data[5] == 1 else ">"
+        if self.is64:
+            fields = struct.unpack_from(self.endian + "HHIQQQIHHHHHH", self.data, 16)
+        else:
+            fields = struct.unpack_from(self.endian + "HHIIIIIHHHHHH", self.data, 16)
+        self.machine = fields[1]
+        shoff, shentsize, shnum = fields[5], fields[10], fields[11]
+
+        self.sections = []
+        for i in range(shnum):
+            off = shoff + i * shentsize
+            if self.is64:
+                (_, stype, flags, addr, offset, size, link, _, _, entsize) = struct.unpack_from(
+                    self.endian + "IIQQQQIIQQ", self.data, off)
+            else:
+                (_, stype, flags, addr, offset, size, link, _, _, entsize) = struct.unpack_from(
+                    self.endian + "IIIIIIIIII", self.data, off)
+            self.sections.append((stype, flags, addr, offset, size, link, entsize))
+
+    def symbol(self, name):
+        for stype, _, _, offset, size, link, entsize in self.sections:
+            if stype != SHT_SYMTAB:
+                continue
+            strtab = self.sections[link][3]
+            for off in range(offset, offset + size, entsize):
+                if self.is64:
+                    st_name, _, _, _, value, _ = struct.unpack_from(
+                        self.endian + "IBBHQQ", self.data, off)
+                else:
+                    st_name, value, _, _, _, _ = struct.unpack_from(
+                        self.endian + "IIIBBH", self.data, off)
+                end = self.data.index(b"\0", strtab + st_name)
+                if self.data[strtab + st_name:end].decode() == name:
+                    return value
+        raise KeyError(f"{name} not found, was the firmware built with SKIRT_LOG?")
+
+    def string(self, address):
+        for stype, flags, addr, offset, size, _, _ in self.sections:
+            if stype == SHT_NOBITS or not flags & SHF_ALLOC:
+                continue
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode("latin-1")
+        return None
+
+    def int_bits(self):
+        return 16 if self.machine == EM_AVR else 32
+
+    def long_bits(self):
+        return 64 if self.is64 else 32
+
+
+def read_varints(payload):
+    values = []
+    value = shift = 0
+    for byte in payload:
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            # Zigzag back to a signed number.
+            values.append((value >> 1) ^ -(value & 1))
+            value = shift = 0
+    return values
+
+
+def format_record(fmt, args, int_bits, long_bits):
+    args = list(args)
+
+    def convert(match):
+        flags, length, conv = match.groups()
+        if conv == "%":
+            return "%"
+        if not args:
+            return "<missing>"
+        value = args.pop(0)
+        bits = long_bits if length in ("l", "ll", "z") else int_bits
+        mask = (1 << bits) - 1
+        if conv in "di":
+            value &= mask
+            if value >> (bits - 1):
+                value -= 1 << bits
+            return ("%" + flags + "d") % value
+        if conv == "c":
+            return chr(value & 0xFF)
+        return ("%" + flags + conv) % (value & mask)
+
+    return CONVERSION.sub(convert, fmt).rstrip("\r\n")
+
+
+class Decoder:
+    def __init__(self, elf, out):
+        self.elf = elf
+        self.out = out
+        self.anchor = elf.symbol(ANCHOR)
+        self.pending = bytearray()
+        self.wire = 0
+        self.text = 0
+        self.records = 0
+
+    def feed(self, data):
+        self.wire += len(data)
+        self.pending += data
+        while self.pending:
+            mark = self.pending.find(MARK)
+            if mark < 0:
+                self.emit(self.pending.decode("latin-1"))
+                self.pending.clear()
+                return
+            if mark:
+                self.emit(self.pending[:mark].decode("latin-1"))
+                del self.pending[:mark]
+            if len(self.pending) < 2 or len(self.pending) < 2 + self.pending[1]:
+                return
+            payload = bytes(self.pending[2:2 + self.pending[1]])
+            del self.pending[:2 + len(payload)]
+            self.record(payload)
+
+    def record(self, payload):
+        values = read_varints(payload)
+        if not values:
+            return
+        self.records += 1
+        fmt = self.elf.string(self.anchor + values[0])
+        if fmt is None:
+            line = f"<unknown log id {values[0]}: {values[1:]}>"
+        else:
+            line = format_record(fmt, values[1:], self.elf.int_bits(), self.elf.long_bits())
+        self.emit(line + "\n")
+
+    def emit(self, text):
+        self.text += len(text)
+        self.out.write(text)
+        self.out.flush()
+
+
+def chunks(path, baud):
+    if path == "-":
+        stream = sys.stdin.buffer
+    elif not path.startswith("/dev/"):
+        stream = open(path, "rb")
+    else:
+        import serial  # Only needed for live captures.
+
+        port = serial.Serial(path, baud, timeout=0.1)
+        while True:
+            yield port.read(256)
+
+    chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+    while chunk:
+        yield chunk
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("elf", help="firmware ELF file")
+    parser.add_argument("input", help="capture file, serial port or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--stats", action="store_true",
+                        help="print received bytes against expanded text on exit")
+    args = parser.parse_args()
+
+    decoder = Decoder(Elf(args.elf), sys.stdout)
+    try:
+        for chunk in chunks(args.input, args.baud):
+            decoder.feed(chunk)
+    except (KeyboardInterrupt, BrokenPipeError):
+        pass
+
+    if args.stats:
+        ratio = decoder.text / decoder.wire if decoder.wire else 0
+        print(f"# {decoder.records} records, {decoder.wire} bytes received, "
+              f"{decoder.text} bytes of text ({ratio:.1f}x)", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Map a SKIRT profiler dump (see include/sk/profile.h) to functions.
+
+The input is the text printed by sk_profile_dump(), either a capture file or a
+serial port (needs pyserial). Symbols are read from the firmware ELF with nm.
+
+    skirt_profile.py firmware.elf capture.txt
+    skirt_profile.py firmware.elf /dev/ttyACM0 --nm avr-nm
+"""
+
+import argparse
+import bisect
+import collections
+import re
+import subprocess
+import sys
+
+LINE = re.compile(r"^(\d+) (\d+) (\d+)\s*$")
+DROPPED = re.compile(r"^# dropped (\d+)")
+
+
+def read_input(path, baud, duration):
+    if not path.startswith("/dev/"):
+        with open(path, "r", errors="replace") as f:
+            return f.read()
+
+    import serial  # Only needed for live captures.
+
+    data = bytearray()
+    with serial.Serial(path, baud, timeout=duration) as port:
+        chunk = port.read(4096)
+        while chunk:
+            data += chunk
+            if b"# dropped" in data:
+                data += port.readline()
+                break
+            chunk = port.read(4096)
+    return data.decode("ascii", errors="replace")
+
+
+def parse_dump(text):
+    """Return ([(tid, address, count)], dropped) for the last dump in text."""
+    text = text.replace("\r", "")
+    start = text.rfind("# skirt profile")
+    if start < 0:
+        sys.exit("no profile dump found in input")
+
+    samples = []
+    dropped = 0
+    for line in text[start:].splitlines()[1:]:
+        m = LINE.match(line)
+        if m:
+            samples.append(tuple(int(x) for x in m.groups()))
+            continue
+        m = DROPPED.match(line)
+        if m:
+            dropped = int(m.group(1))
+            break
+    return samples, dropped
+
+
+def load_symbols(nm, elf):
+    """Return sorted (address, name) of code symbols."""
+    out = subprocess.run([nm, "-n", "--defined-only", elf], check=True,
+                         capture_output=True, text=True).stdout
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[1] in "tTwW":
+            symbols.append((int(parts[0], 16), parts[2]))
+    return symbols
+
+
+def lookup(symbols, addresses, address):
+    i = bisect.bisect_right(addresses, address) - 1
+    return symbols[i][1] if i >= 0 else "0x%04x" % address
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("elf", help="firmware ELF file")
+    parser.add_argument("input", help="capture file or serial port")
+    parser.add_argument("--nm", default="avr-nm", help="nm executable")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--duration", type=float, default=2.0,
+                        help="stop reading a serial port after this many "
+                        "seconds of silence")
+    parser.add_argument("--per-task", action="store_true",
+                        help="split functions by task ID")
+    args = parser.parse_args()
+
+    samples, dropped = parse_dump(read_input(args.input, args.baud,
+                                             args.duration))
+    symbols = load_symbols(args.nm, args.elf)
+    addresses = [a for a, _ in symbols]
+
+    totals = collections.Counter()
+    for tid, address, count in samples:
+        func = lookup(symbols, addresses, address)
+        totals[(tid, func) if args.per_task else func] += count
+
+    total = sum(totals.values()) + dropped
+    if not total:
+        sys.exit("profile is empty")
+
+    print("%8s %6s  %s" % ("samples", "%", "function"))
+    for key, count in totals.most_common():
+        name = "[%d] %s" % key if args.per_task else key
+        print("%8d %6.2f  %s" % (count, 100.0 * count / total, name))
+    if dropped:
+        print("%8d %6.2f  (dropped, raise SKIRT_PROFILE_SZ or SKIRT_PROFILE_SHIFT)"
+              % (dropped, 100.0 * dropped / total))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+Decode a SKIRT binary trace (see include/sk/trace.h) into a Chrome trace.
+
+The input is the raw serial stream produced by sk_trace_flush(), either a
+capture file or a serial port (needs pyserial). The output can be loaded in
+chrome://tracing or https://ui.perfetto.dev.
+
+    skirt_trace.py capture.bin -o trace.json
+    skirt_trace.py /dev/ttyACM0 --baud 115200 -o trace.json
+"""
+
+import argparse
+import json
+import sys
+
+SYNC = b"\xa5\x5a"
+REC_SZ = 4
+
+# Keep in sync with sk_trace_event in include/sk/trace.h.
+SWITCH = 1
+WAKE = 2
+ISR_ENTER = 3
+ISR_EXIT = 4
+SEM_ACQUIRE = 5
+SEM_BLOCK = 6
+SEM_RELEASE = 7
+MAIL_SEND = 8
+MAIL_PICKUP = 9
+LOST = 10
+MSG_SEND = 11
+MSG_RECEIVE = 12
+MSG_REPLY = 13
+USER = 0x80
+
+NAMES = {
+    WAKE: "wake",
+    SEM_ACQUIRE: "sem_acquire",
+    SEM_BLOCK: "sem_block",
+    SEM_RELEASE: "sem_release",
+    MAIL_SEND: "mail_send",
+    MAIL_PICKUP: "mail_pickup",
+    MSG_SEND: "msg_send",
+    MSG_RECEIVE: "msg_receive",
+    MSG_REPLY: "msg_reply",
+}
+
+
+def read_input(path, baud, duration):
+    if not path.startswith("/dev/"):
+        with open(path, "rb") as f:
+            return f.read()
+
+    import serial  # Only needed for live captures.
+
+    data = bytearray()
+    with serial.Serial(path, baud, timeout=duration) as port:
+        chunk = port.read(4096)
+        while chunk:
+            data += chunk
+            chunk = port.read(4096)
+    return bytes(data)
+
+
+def parse_blocks(data):
+    """Yield (event, arg, stamp) from every well-formed block in data."""
+    pos = data.find(SYNC)
+    while pos >= 0 and pos + 3 <= len(data):
+        count = data[pos + 2]
+        start = pos + 3
+        end = start + count * REC_SZ
+        if end > len(data):
+            break
+        for i in range(start, end, REC_SZ):
+            event, arg, lo, hi = data[i:i + REC_SZ]
+            yield event, arg, lo | (hi << 8)
+        pos = data.find(SYNC, end)
+
+
+def unwrap(records):
+    """Turn 16-bit stamps into monotonic counts, gaps must stay under 65536."""
+    last = None
+    base = 0
+    for event, arg, stamp in records:
+        if event == LOST:
+            yield event, arg, None
+            continue
+        if last is not None and stamp < last:
+            base += 0x10000
+        last = stamp
+        yield event, arg, base + stamp
+
+
+def to_chrome(records, us_per_count):
+    events = []
+    running = None
+    now = 0.0
+
+    def end_running(ts):
+        if running is not None:
+            events.append({"name": "task %d" % running, "ph": "E",
+                           "pid": 0, "tid": running, "ts": ts})
+
+    for event, arg, stamp in records:
+        if stamp is not None:
+            now = stamp * us_per_count
+        if event == SWITCH:
+            end_running(now)
+            running = arg
+            events.append({"name": "task %d" % arg, "ph": "B",
+                           "pid": 0, "tid": arg, "ts": now})
+        elif event in (ISR_ENTER, ISR_EXIT):
+            events.append({"name": "irq 0x%02x" % arg,
+                           "ph": "B" if event == ISR_ENTER else "E",
+                           "pid": 1, "tid": arg, "ts": now})
+        elif event == LOST:
+            events.append({"name": "lost %d records" % arg, "ph": "i",
+                           "s": "g", "pid": 0, "tid": 0, "ts": now})
+        else:
+            name = NAMES.get(event)
+            if name is None:
+                name = "user %d" % (event - USER) if event >= USER \
+                    else "unknown %d" % event
+            events.append({"name": name, "ph": "i", "s": "t",
+                           "pid": 0, "tid": running if running is not None
+                           else 0, "ts": now, "args": {"arg": arg}})
+    end_running(now)
+
+    meta = [{"name": "process_name", "ph": "M", "pid": 0,
+             "args": {"name": "tasks"}},
+            {"name": "process_name", "ph": "M", "pid": 1,
+             "args": {"name": "interrupts"}}]
+    return {"traceEvents": meta + events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("input", help="capture file or serial port")
+    parser.add_argument("-o", "--output", help="JSON output (stdout if not set)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--duration", type=float, default=2.0,
+                        help="stop reading a serial port after this many "
+                        "seconds of silence")
+    parser.add_argument("--us-per-count", type=float, default=16.0,
+                        help="timer count duration, 16 for a /256 prescaler "
+                        "at 16MHz")
+    args = parser.parse_args()
+
+    data = read_input(args.input, args.baud, args.duration)
+    trace = to_chrome(unwrap(parse_blocks(data)), args.us_per_count)
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(trace, out, indent=1)
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()